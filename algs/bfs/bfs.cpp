@@ -2,13 +2,47 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <random>
+#include <thread>
+#include "../common/csr_graph.h"
+#include "../common/bench.h"
+#include "../common/thread_pool.h"
+#include "../common/epoch_array.h"
+#include "../common/graph_file.h"
+#include "../common/graph_reorder.h"
+#include "../common/compressed_graph.h"
+#include "../common/query_server.h"
 using namespace std;
 
 typedef int Node;
 
 typedef vector< vector<Node> > Graph;
 
-bool bfsCore(const Graph &graph, Node start, Node goal, vector<Node> &parent) {
+// Fills the path vector with the path from start node to goal node, by following the parents in the given parent array.
+template <typename ParentArray>
+void tracePath(const ParentArray &parent, Node start, Node goal, vector<Node> &path) {
+    path.clear();
+    // Start with the goal state and go back the path
+    Node curr = goal;
+    // until we reach the start state
+    while (curr != start) {
+        // by following the parent of each next node
+        path.push_back(curr);
+        curr = parent[curr];
+    }
+    // In the end we have to add the start node and reverse the path so that it begins with the start and ends at the goal
+    path.push_back(start);
+    reverse(path.begin(), path.end());
+}
+
+/// The graph can be either a Graph or a CsrGraph<Node>, both provide size() and operator[] for the neighbours of a node.
+/// The parent array can be either a vector<Node> or the EpochArray<Node> of a BfsWorkspace.
+template <typename GraphT, typename ParentArray>
+bool bfsCore(const GraphT &graph, Node start, Node goal, ParentArray &parent) {
     // Setup a queue of visited nodes waiting to have their neighbours searched. Begin with the start node only.
     queue<Node> visQu;
     visQu.push(start);
@@ -35,29 +69,672 @@ bool bfsCore(const Graph &graph, Node start, Node goal, vector<Node> &parent) {
 
 /// Breadth-first search the shortest path from start node to goal node of the given graph.
 /// The function returns true if a path is found, and fills the path vector with it.
-bool bfs(const Graph &graph, Node start, Node goal, vector<Node> &path) {
+template <typename GraphT>
+bool bfs(const GraphT &graph, Node start, Node goal, vector<Node> &path) {
     // Setup parents array that keeps track of the parent of each node, -1 for no parent.
     vector<Node> parent(graph.size(), -1);
     parent[start] = -2;
     // Perform the actual BFS to search for a path and fill the parent array
     if (bfsCore(graph, start, goal, parent)) {
-        path.clear();
-        // Start with the goal state and go back the path
-        Node curr = goal;
-        // until we reach the start state
-        while (curr != start) {
-            // by following the parent of each next node
+        tracePath(parent, start, goal, path);
+        return true;
+    }
+    return false;
+}
+
+/// Memory for BFS queries that is kept by the caller and reused across queries on graphs with the same number of nodes.
+/// Resetting it is O(1), so a query that touches only a few nodes of a huge graph costs only as much as those nodes.
+struct BfsWorkspace {
+    BfsWorkspace(int nodesCount)
+        : parent(nodesCount, -1)
+    {}
+
+    EpochArray<Node> parent;
+};
+
+/// Breadth-first search the shortest path from start node to goal node of the given graph, reusing the given workspace.
+/// The function returns true if a path is found, and fills the path vector with it.
+template <typename GraphT>
+bool bfs(const GraphT &graph, Node start, Node goal, vector<Node> &path, BfsWorkspace &workspace) {
+    workspace.parent.reset();
+    workspace.parent[start] = -2;
+    if (bfsCore(graph, start, goal, workspace.parent)) {
+        tracePath(workspace.parent, start, goal, path);
+        return true;
+    }
+    return false;
+}
+
+// Bit set with one bit per node, used for the frontier and visited sets of the level-synchronous BFS
+struct Bitmap {
+    Bitmap(int bitsCount)
+        : words((bitsCount + 63) / 64, 0)
+    {}
+
+    bool get(int idx) const {
+        return (words[idx >> 6] >> (idx & 63)) & 1;
+    }
+
+    void set(int idx) {
+        words[idx >> 6] |= uint64_t(1) << (idx & 63);
+    }
+
+    void clear() {
+        fill(words.begin(), words.end(), 0);
+    }
+
+    void swap(Bitmap &other) {
+        words.swap(other.words);
+    }
+
+private:
+    vector<uint64_t> words;
+};
+
+// Heuristic thresholds for switching between top-down and bottom-up steps, as suggested by Beamer et al.
+// Switch to bottom-up when the edges out of the frontier are more than 1/ALPHA of the edges out of unvisited nodes,
+// and back to top-down when the frontier has less than 1/BETA of all nodes.
+const int DIR_OPT_ALPHA = 14;
+const int DIR_OPT_BETA = 24;
+
+/// Level-synchronous BFS that switches between top-down and bottom-up steps depending on the size of the frontier.
+/// A top-down step goes through the out-edges of the frontier nodes, like bfsCore() does.
+/// A bottom-up step goes through the in-edges of every unvisited node until it finds one coming from the frontier,
+/// which is much cheaper in the few huge middle levels of low-diameter graphs.
+/// The reverse graph must be built from the graph with buildReverseCsr(). The parent array is filled like in bfsCore().
+bool bfsCoreDirOpt(const CsrGraph<Node> &graph, const CsrGraph<Node> &reverseGraph, Node start, Node goal, vector<Node> &parent) {
+    const int nodesCount = graph.size();
+    // The frontier is kept as a list of nodes in top-down steps and as a bitmap in bottom-up steps
+    vector<Node> frontier = { start };
+    vector<Node> nextFrontier;
+    Bitmap frontierBits(nodesCount);
+    Bitmap nextFrontierBits(nodesCount);
+    Bitmap visited(nodesCount);
+    visited.set(start);
+    bool bottomUp = false;
+    long long frontierEdges = graph.degree(start);
+    long long unvisitedEdges = graph.edgesCount() - frontierEdges;
+    int frontierSize = 1;
+    while (frontierSize > 0) {
+        // Decide the direction of the next step from the sizes of the frontier and the unvisited part of the graph
+        if (!bottomUp && frontierEdges > unvisitedEdges / DIR_OPT_ALPHA) {
+            // Switching to bottom-up, so move the frontier from the list to the bitmap
+            bottomUp = true;
+            frontierBits.clear();
+            for (const Node node : frontier) {
+                frontierBits.set(node);
+            }
+        }
+        else if (bottomUp && frontierSize < nodesCount / DIR_OPT_BETA) {
+            // Switching to top-down, so move the frontier from the bitmap to the list
+            bottomUp = false;
+            frontier.clear();
+            for (Node node = 0; node < nodesCount; node++) {
+                if (frontierBits.get(node)) {
+                    frontier.push_back(node);
+                }
+            }
+        }
+
+        int nextFrontierSize = 0;
+        long long nextFrontierEdges = 0;
+        if (bottomUp) {
+            nextFrontierBits.clear();
+            // Every unvisited node looks for a parent among its in-neighbours in the frontier
+            for (Node node = 0; node < nodesCount; node++) {
+                if (visited.get(node)) {
+                    continue;
+                }
+                for (const Node inNeigh : reverseGraph[node]) {
+                    if (frontierBits.get(inNeigh)) {
+                        parent[node] = inNeigh;
+                        visited.set(node);
+                        nextFrontierBits.set(node);
+                        nextFrontierSize++;
+                        nextFrontierEdges += graph.degree(node);
+                        break;
+                    }
+                }
+            }
+            frontierBits.swap(nextFrontierBits);
+        }
+        else {
+            nextFrontier.clear();
+            // Every frontier node claims its unvisited out-neighbours
+            for (const Node curr : frontier) {
+                for (const Node neigh : graph[curr]) {
+                    if (!visited.get(neigh)) {
+                        parent[neigh] = curr;
+                        visited.set(neigh);
+                        nextFrontier.push_back(neigh);
+                        nextFrontierEdges += graph.degree(neigh);
+                    }
+                }
+            }
+            nextFrontierSize = int(nextFrontier.size());
+            frontier.swap(nextFrontier);
+        }
+        // The goal is found at the end of the level it belongs to, so its path is still a shortest one
+        if (goal >= 0 && visited.get(goal)) {
+            return true;
+        }
+        frontierSize = nextFrontierSize;
+        frontierEdges = nextFrontierEdges;
+        unvisitedEdges -= nextFrontierEdges;
+    }
+    return false;
+}
+
+/// Breadth-first search the shortest path from start node to goal node with direction-optimizing BFS.
+/// The reverse graph must be built from the graph with buildReverseCsr(), once for all searches on the graph.
+/// The function returns true if a path is found, and fills the path vector with it.
+bool bfsDirOpt(const CsrGraph<Node> &graph, const CsrGraph<Node> &reverseGraph, Node start, Node goal, vector<Node> &path) {
+    vector<Node> parent(graph.size(), -1);
+    parent[start] = -2;
+    if (bfsCoreDirOpt(graph, reverseGraph, start, goal, parent)) {
+        tracePath(parent, start, goal, path);
+        return true;
+    }
+    return false;
+}
+
+// Expands one whole level of one side of a bidirectional BFS.
+// The side's own parent array is extended and the other side's parent array is checked for a meeting node.
+// Returns the first node reached by both sides, or -1 if there is none.
+Node expandBidirectionalLevel(const CsrGraph<Node> &graph, vector<Node> &frontier, vector<Node> &nextFrontier,
+                              vector<Node> &parent, const vector<Node> &otherParent) {
+    nextFrontier.clear();
+    for (const Node curr : frontier) {
+        for (const Node neigh : graph[curr]) {
+            if (parent[neigh] == -1) {
+                parent[neigh] = curr;
+                // All meeting nodes in this level are equally far from the other side's root,
+                // so the first one found already lies on a shortest path
+                if (otherParent[neigh] != -1) {
+                    return neigh;
+                }
+                nextFrontier.push_back(neigh);
+            }
+        }
+    }
+    frontier.swap(nextFrontier);
+    return -1;
+}
+
+/// Bidirectional BFS, searching forward from the start node on the graph and backward from the goal node on the reverse graph,
+/// always expanding a whole level of the side with the smaller frontier, until the two sides meet.
+/// The forward parent array is setup like for bfsCore(). The backward parent array has -1 for all nodes except -2 for the goal,
+/// and gets filled with the next node on the way to the goal. The node where the two searches met is stored in meetNode.
+bool bfsCoreBidirectional(const CsrGraph<Node> &graph, const CsrGraph<Node> &reverseGraph, Node start, Node goal,
+                          vector<Node> &forwardParent, vector<Node> &backwardParent, Node &meetNode) {
+    if (start == goal) {
+        meetNode = start;
+        return true;
+    }
+    vector<Node> forwardFrontier = { start };
+    vector<Node> backwardFrontier = { goal };
+    vector<Node> nextFrontier;
+    while (!forwardFrontier.empty() && !backwardFrontier.empty()) {
+        if (forwardFrontier.size() <= backwardFrontier.size()) {
+            meetNode = expandBidirectionalLevel(graph, forwardFrontier, nextFrontier, forwardParent, backwardParent);
+        }
+        else {
+            meetNode = expandBidirectionalLevel(reverseGraph, backwardFrontier, nextFrontier, backwardParent, forwardParent);
+        }
+        if (meetNode != -1) {
+            return true;
+        }
+    }
+    // One of the sides has run out of nodes without meeting the other, so there is no path
+    return false;
+}
+
+/// Breadth-first search the shortest path from start node to goal node with a bidirectional BFS.
+/// The reverse graph must be built from the graph with buildReverseCsr(), once for all searches on the graph.
+/// The function returns true if a path is found, and fills the path vector with it.
+bool bfsBidirectional(const CsrGraph<Node> &graph, const CsrGraph<Node> &reverseGraph, Node start, Node goal, vector<Node> &path) {
+    vector<Node> forwardParent(graph.size(), -1);
+    vector<Node> backwardParent(graph.size(), -1);
+    forwardParent[start] = -2;
+    backwardParent[goal] = -2;
+    Node meetNode;
+    if (bfsCoreBidirectional(graph, reverseGraph, start, goal, forwardParent, backwardParent, meetNode)) {
+        // The first half of the path goes from the start to the meeting node
+        tracePath(forwardParent, start, meetNode, path);
+        // and the second half follows the backward parents from the meeting node to the goal
+        for (Node curr = backwardParent[meetNode]; curr >= 0; curr = backwardParent[curr]) {
             path.push_back(curr);
-            curr = parent[curr];
         }
-        // In the end we have to add the start node and reverse the path so that it begins with the start and ends at the goal
-        path.push_back(start);
-        reverse(path.begin(), path.end());
         return true;
     }
     return false;
 }
 
+// Number of sources searched together in one traversal of the multi-source BFS, one bit of a 64-bit mask per source
+const int MS_BFS_BATCH_SIZE = 64;
+
+/// Multi-source BFS from up to MS_BFS_BATCH_SIZE sources at once, in the style of MS-BFS by Then et al.
+/// Each node keeps a bitmask of the sources that have seen it and of the sources whose frontier it is in,
+/// so a single pass over the graph per level advances the searches from all sources together.
+/// The distance from source i to goal j is stored at distances[i * goals.size() + j], or -1 if the goal is unreachable.
+/// If parents is not null, it gets the BFS parent of each node for each source, at (*parents)[i * graph.size() + node].
+void msBfsCore(const CsrGraph<Node> &graph, const vector<Node> &sources, const vector<Node> &goals,
+               vector<int> &distances, vector<Node> *parents) {
+    const int nodesCount = graph.size();
+    const int sourcesCount = int(sources.size());
+    const int goalsCount = int(goals.size());
+    vector<uint64_t> seen(nodesCount, 0);
+    vector<uint64_t> visit(nodesCount, 0);
+    vector<uint64_t> visitNext(nodesCount, 0);
+    distances.assign(size_t(sourcesCount) * goalsCount, -1);
+    if (parents != nullptr) {
+        parents->assign(size_t(sourcesCount) * nodesCount, -1);
+    }
+    for (int srcIdx = 0; srcIdx < sourcesCount; srcIdx++) {
+        seen[sources[srcIdx]] |= uint64_t(1) << srcIdx;
+        visit[sources[srcIdx]] |= uint64_t(1) << srcIdx;
+        if (parents != nullptr) {
+            (*parents)[size_t(srcIdx) * nodesCount + sources[srcIdx]] = -2;
+        }
+    }
+    for (int level = 0; ; level++) {
+        // Record the distances of the goals that are in the frontier of some sources at this level
+        for (int goalIdx = 0; goalIdx < goalsCount; goalIdx++) {
+            for (uint64_t bits = visit[goals[goalIdx]]; bits != 0; bits &= bits - 1) {
+                const int srcIdx = __builtin_ctzll(bits);
+                distances[size_t(srcIdx) * goalsCount + goalIdx] = level;
+            }
+        }
+        // Advance all searches by one level, passing the frontier bits of each node to its neighbours that have not seen them yet
+        bool anyNext = false;
+        for (Node curr = 0; curr < nodesCount; curr++) {
+            const uint64_t currVisit = visit[curr];
+            if (currVisit == 0) {
+                continue;
+            }
+            for (const Node neigh : graph[curr]) {
+                const uint64_t newBits = currVisit & ~seen[neigh];
+                if (newBits == 0) {
+                    continue;
+                }
+                seen[neigh] |= newBits;
+                visitNext[neigh] |= newBits;
+                anyNext = true;
+                if (parents != nullptr) {
+                    for (uint64_t bits = newBits; bits != 0; bits &= bits - 1) {
+                        (*parents)[size_t(__builtin_ctzll(bits)) * nodesCount + neigh] = curr;
+                    }
+                }
+            }
+        }
+        if (!anyNext) {
+            break;
+        }
+        visit.swap(visitNext);
+        fill(visitNext.begin(), visitNext.end(), 0);
+    }
+}
+
+/// Finds the hop distances from every source node to every goal node with as few traversals of the graph as possible,
+/// by searching from batches of MS_BFS_BATCH_SIZE sources at once with msBfsCore().
+/// The distance from source i to goal j is stored at distances[i * goals.size() + j], or -1 if the goal is unreachable.
+/// If paths is not null, it gets the shortest path from source i to goal j at (*paths)[i * goals.size() + j], empty if there is none.
+void msBfs(const CsrGraph<Node> &graph, const vector<Node> &sources, const vector<Node> &goals,
+           vector<int> &distances, vector< vector<Node> > *paths = nullptr) {
+    const int goalsCount = int(goals.size());
+    distances.resize(sources.size() * goals.size());
+    if (paths != nullptr) {
+        paths->assign(sources.size() * goals.size(), vector<Node>());
+    }
+    vector<int> batchDistances;
+    vector<Node> batchParents;
+    for (int batchBegin = 0; batchBegin < int(sources.size()); batchBegin += MS_BFS_BATCH_SIZE) {
+        const int batchEnd = min(batchBegin + MS_BFS_BATCH_SIZE, int(sources.size()));
+        const vector<Node> batchSources(sources.begin() + batchBegin, sources.begin() + batchEnd);
+        msBfsCore(graph, batchSources, goals, batchDistances, (paths != nullptr) ? &batchParents : nullptr);
+        copy(batchDistances.begin(), batchDistances.end(), distances.begin() + size_t(batchBegin) * goalsCount);
+        if (paths == nullptr) {
+            continue;
+        }
+        // Follow the parents of each source from each reachable goal to get the paths
+        for (int srcIdx = 0; srcIdx < int(batchSources.size()); srcIdx++) {
+            const Node *sourceParent = batchParents.data() + size_t(srcIdx) * graph.size();
+            for (int goalIdx = 0; goalIdx < goalsCount; goalIdx++) {
+                if (batchDistances[size_t(srcIdx) * goalsCount + goalIdx] != -1) {
+                    tracePath(sourceParent, batchSources[srcIdx], goals[goalIdx], (*paths)[size_t(batchBegin + srcIdx) * goalsCount + goalIdx]);
+                }
+            }
+        }
+    }
+}
+
+// Number of frontier nodes a thread takes at once in the parallel BFS
+const int PARALLEL_BFS_CHUNK_SIZE = 256;
+
+/// Level-synchronous BFS that expands each frontier level in parallel on the threads of the given pool.
+/// Threads claim unvisited nodes by atomically swapping their parent from -1 to the current node,
+/// so each node gets exactly one parent, and put the claimed nodes into their own buffers for the next frontier.
+/// The parent array must be setup like for bfsCore(), with -1 for all nodes except -2 for the start node.
+bool bfsCoreParallel(const CsrGraph<Node> &graph, Node start, Node goal, vector< atomic<Node> > &parent, ThreadPool &pool) {
+    vector<Node> frontier = { start };
+    vector<Node> nextFrontier;
+    vector< vector<Node> > threadNext(pool.size());
+    vector<int> threadOffsets(pool.size() + 1);
+    while (!frontier.empty()) {
+        // Expand the frontier, each thread taking chunks of frontier nodes and collecting the nodes it claims
+        pool.parallelFor(int(frontier.size()), PARALLEL_BFS_CHUNK_SIZE, [&](int threadIdx, int begin, int end) {
+            vector<Node> &localNext = threadNext[threadIdx];
+            for (int idx = begin; idx < end; idx++) {
+                const Node curr = frontier[idx];
+                for (const Node neigh : graph[curr]) {
+                    // Check with a plain load first, so that only nodes that look unvisited pay for the compare-and-swap
+                    Node expected = -1;
+                    if (parent[neigh].load(memory_order_relaxed) == -1
+                        && parent[neigh].compare_exchange_strong(expected, curr, memory_order_relaxed)) {
+                        localNext.push_back(neigh);
+                    }
+                }
+            }
+        });
+        // The goal is found at the end of the level it belongs to, so its path is still a shortest one
+        if (goal >= 0 && parent[goal].load(memory_order_relaxed) != -1) {
+            return true;
+        }
+        // Concatenate the per-thread buffers into the next frontier, each thread copying its own buffer
+        for (int threadIdx = 0; threadIdx < pool.size(); threadIdx++) {
+            threadOffsets[threadIdx + 1] = threadOffsets[threadIdx] + int(threadNext[threadIdx].size());
+        }
+        nextFrontier.resize(threadOffsets.back());
+        pool.runOnAll([&](int threadIdx) {
+            copy(threadNext[threadIdx].begin(), threadNext[threadIdx].end(), nextFrontier.begin() + threadOffsets[threadIdx]);
+            threadNext[threadIdx].clear();
+        });
+        frontier.swap(nextFrontier);
+    }
+    return false;
+}
+
+/// Breadth-first search the shortest path from start node to goal node with a parallel BFS on the threads of the given pool.
+/// The function returns true if a path is found, and fills the path vector with it.
+bool bfsParallel(const CsrGraph<Node> &graph, Node start, Node goal, vector<Node> &path, ThreadPool &pool) {
+    vector< atomic<Node> > parent(graph.size());
+    pool.parallelFor(graph.size(), 1 << 16, [&](int, int begin, int end) {
+        for (Node node = begin; node < end; node++) {
+            parent[node].store(-1, memory_order_relaxed);
+        }
+    });
+    parent[start] = -2;
+    if (bfsCoreParallel(graph, start, goal, parent, pool)) {
+        tracePath(parent, start, goal, path);
+        return true;
+    }
+    return false;
+}
+
+// Hub of the entry that ends every hub label, greater than all real hubs, so that merging two labels needs no bounds checks
+const int HUB_LABEL_END = 2147483647;
+
+/// Entry of a hub label, the rank of the hub in the order the hubs were processed and the hop distance between the node and the hub.
+struct HubLabelEntry {
+    int hub;
+    int dist;
+};
+
+/// Hub labels (a 2-hop cover) of a graph, where every node has an out-label with hubs it reaches and an in-label with hubs
+/// that reach it, together with the distances. Every shortest path from u to v passes through a hub that is both in the
+/// out-label of u and in the in-label of v, so their distance is found by a merge of these two labels alone.
+/// All labels are stored one after another in a single entries array, each sorted by hub and ended with a HUB_LABEL_END entry.
+/// The out-label of node i starts at offsets[2 * i] and its in-label at offsets[2 * i + 1].
+/// The view does not own its memory, which is either kept by a HubLabels or mapped from a file by a HubLabelFile.
+struct HubLabelView {
+    int nodesCount = 0;
+    const int64_t *offsets = nullptr;
+    const HubLabelEntry *entries = nullptr;
+
+    const HubLabelEntry* outLabel(Node node) const {
+        return entries + offsets[2 * node];
+    }
+
+    const HubLabelEntry* inLabel(Node node) const {
+        return entries + offsets[2 * node + 1];
+    }
+
+    /// Returns the number of entries in all labels, without the ones that end the labels
+    int64_t labelEntriesCount() const {
+        return offsets[2 * nodesCount] - 2 * int64_t(nodesCount);
+    }
+
+    size_t sizeInBytes() const {
+        return (2 * size_t(nodesCount) + 1) * sizeof(int64_t) + size_t(offsets[2 * nodesCount]) * sizeof(HubLabelEntry);
+    }
+};
+
+/// Hub labels kept in memory, as built by buildHubLabels().
+struct HubLabels {
+    int nodesCount = 0;
+    vector<int64_t> offsets;
+    vector<HubLabelEntry> entries;
+
+    HubLabelView view() const {
+        return { nodesCount, offsets.data(), entries.data() };
+    }
+};
+
+/// Returns the hop distance from one node to another, or -1 if there is no path, by a merge-join of the out-label
+/// of the first node with the in-label of the second one, taking the shortest way through any hub they share.
+inline int hubLabelDistance(const HubLabelView &labels, Node from, Node to) {
+    const HubLabelEntry *outEntry = labels.outLabel(from);
+    const HubLabelEntry *inEntry = labels.inLabel(to);
+    int bestDist = HUB_LABEL_END;
+    while (true) {
+        if (outEntry->hub == inEntry->hub) {
+            if (outEntry->hub == HUB_LABEL_END) {
+                break;
+            }
+            bestDist = min(bestDist, outEntry->dist + inEntry->dist);
+            ++outEntry;
+            ++inEntry;
+        }
+        else if (outEntry->hub < inEntry->hub) {
+            ++outEntry;
+        }
+        else {
+            ++inEntry;
+        }
+    }
+    return (bestDist == HUB_LABEL_END) ? -1 : bestDist;
+}
+
+// Runs the pruned BFS of one hub on the graph, adding the hub to the labels of the nodes it reaches.
+// On the graph it fills the in-labels and on the reverse graph the out-labels.
+// The root's own labels of the other direction are given in rootHubDist, indexed by hub, HUB_LABEL_END for the hubs not in them.
+// A node is not labelled, and its neighbours not searched, if the labels so far already give a path to it that is not longer,
+// as all shortest paths through it are then covered by earlier hubs.
+template <typename GraphT>
+void prunedHubBfs(const GraphT &graph, Node root, int rootRank, const vector<int> &rootHubDist,
+                  vector< vector<HubLabelEntry> > &labels, EpochArray<int> &dist, vector<Node> &queue) {
+    dist.reset();
+    dist[root] = 0;
+    queue.assign(1, root);
+    for (int queueIdx = 0; queueIdx < int(queue.size()); queueIdx++) {
+        const Node curr = queue[queueIdx];
+        const int currDist = dist[curr];
+        bool covered = false;
+        for (const HubLabelEntry &entry : labels[curr]) {
+            if (rootHubDist[entry.hub] != HUB_LABEL_END && rootHubDist[entry.hub] + entry.dist <= currDist) {
+                covered = true;
+                break;
+            }
+        }
+        if (covered) {
+            continue;
+        }
+        labels[curr].push_back({ rootRank, currDist });
+        for (const Node neigh : graph[curr]) {
+            if (dist[neigh] == -1) {
+                dist[neigh] = currDist + 1;
+                queue.push_back(neigh);
+            }
+        }
+    }
+}
+
+/// Builds hub labels for the graph with pruned landmark labeling by Akiba, Iwata and Yoshida.
+/// Every node in turn, from the highest degree down, is made a hub with a BFS forward and one backward from it,
+/// pruned at the nodes whose distance the earlier hubs already cover. Hubs processed early cover most shortest paths,
+/// so the later searches stay small, and graphs with a small diameter and a few high degree nodes get short labels.
+/// Hubs are added in the order they are processed, so every label comes out sorted by hub.
+template <typename GraphT>
+HubLabels buildHubLabels(const GraphT &graph) {
+    const int nodesCount = int(graph.size());
+    Graph reverseGraph(nodesCount);
+    for (Node node = 0; node < nodesCount; node++) {
+        for (const Node neigh : graph[node]) {
+            reverseGraph[neigh].push_back(node);
+        }
+    }
+    const NodeOrder order = computeDegreeOrder(graph);
+
+    vector< vector<HubLabelEntry> > outLabels(nodesCount);
+    vector< vector<HubLabelEntry> > inLabels(nodesCount);
+    vector<int> rootHubDist(nodesCount, HUB_LABEL_END);
+    EpochArray<int> dist(nodesCount, -1);
+    vector<Node> queue;
+    for (int rank = 0; rank < nodesCount; rank++) {
+        const Node root = order.toOld[rank];
+        // The forward search reaches nodes from the root, and its paths can be covered by going from the root to an earlier hub first
+        for (const HubLabelEntry &entry : outLabels[root]) {
+            rootHubDist[entry.hub] = entry.dist;
+        }
+        prunedHubBfs(graph, root, rank, rootHubDist, inLabels, dist, queue);
+        for (const HubLabelEntry &entry : outLabels[root]) {
+            rootHubDist[entry.hub] = HUB_LABEL_END;
+        }
+        // and the backward search the other way around
+        for (const HubLabelEntry &entry : inLabels[root]) {
+            rootHubDist[entry.hub] = entry.dist;
+        }
+        prunedHubBfs(reverseGraph, root, rank, rootHubDist, outLabels, dist, queue);
+        for (const HubLabelEntry &entry : inLabels[root]) {
+            rootHubDist[entry.hub] = HUB_LABEL_END;
+        }
+    }
+
+    // Pack all labels into one array
+    HubLabels labels;
+    labels.nodesCount = nodesCount;
+    labels.offsets.resize(2 * size_t(nodesCount) + 1);
+    int64_t entriesCount = 0;
+    for (Node node = 0; node < nodesCount; node++) {
+        labels.offsets[2 * node] = entriesCount;
+        entriesCount += int64_t(outLabels[node].size()) + 1;
+        labels.offsets[2 * node + 1] = entriesCount;
+        entriesCount += int64_t(inLabels[node].size()) + 1;
+    }
+    labels.offsets[2 * nodesCount] = entriesCount;
+    labels.entries.reserve(entriesCount);
+    for (Node node = 0; node < nodesCount; node++) {
+        labels.entries.insert(labels.entries.end(), outLabels[node].begin(), outLabels[node].end());
+        labels.entries.push_back({ HUB_LABEL_END, 0 });
+        vector<HubLabelEntry>().swap(outLabels[node]);
+        labels.entries.insert(labels.entries.end(), inLabels[node].begin(), inLabels[node].end());
+        labels.entries.push_back({ HUB_LABEL_END, 0 });
+        vector<HubLabelEntry>().swap(inLabels[node]);
+    }
+    return labels;
+}
+
+/// Binary hub label file layout, in the native byte order:
+///   header            HubLabelFileHeader
+///   offsets           2 * nodesCount + 1 64-bit values, laid out like in HubLabelView
+///   entries           entriesCount HubLabelEntry values, two 32-bit integers each
+/// The offsets start right after the 24 bytes of the header, so both arrays are aligned and can be used in place.
+struct HubLabelFileHeader {
+    char magic[4];
+    int version;
+    int nodesCount;
+    int reserved;
+    int64_t entriesCount;
+};
+
+const char HUB_LABEL_FILE_MAGIC[4] = { 'F', 'M', 'I', 'H' };
+const int HUB_LABEL_FILE_VERSION = 1;
+
+/// Writes the hub labels to a file, which can then be mapped with HubLabelFile.
+void writeHubLabelFile(const char *filepath, const HubLabelView &labels) {
+    FILE *file = fopen(filepath, "wb");
+    if (file == nullptr) {
+        throw runtime_error("Cannot open hub label file for writing.");
+    }
+    HubLabelFileHeader header;
+    memcpy(header.magic, HUB_LABEL_FILE_MAGIC, sizeof(HUB_LABEL_FILE_MAGIC));
+    header.version = HUB_LABEL_FILE_VERSION;
+    header.nodesCount = labels.nodesCount;
+    header.reserved = 0;
+    header.entriesCount = labels.offsets[2 * labels.nodesCount];
+    const size_t offsetsCount = 2 * size_t(labels.nodesCount) + 1;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    written = written && fwrite(labels.offsets, sizeof(int64_t), offsetsCount, file) == offsetsCount;
+    written = written && fwrite(labels.entries, sizeof(HubLabelEntry), size_t(header.entriesCount), file) == size_t(header.entriesCount);
+    if (fclose(file) != 0 || !written) {
+        throw runtime_error("Cannot write hub label file.");
+    }
+}
+
+/// Hub label file mapped into memory. The view points directly into the mapping, so it is valid while the HubLabelFile lives.
+struct HubLabelFile {
+    HubLabelFile(const char *filepath)
+        : file(filepath)
+    {
+        HubLabelFileHeader header;
+        if (file.getSize() < sizeof(HubLabelFileHeader)) {
+            throw runtime_error("Hub label file is too small.");
+        }
+        memcpy(&header, file.getData(), sizeof(HubLabelFileHeader));
+        if (memcmp(header.magic, HUB_LABEL_FILE_MAGIC, sizeof(HUB_LABEL_FILE_MAGIC)) != 0 || header.version != HUB_LABEL_FILE_VERSION
+            || header.nodesCount < 0 || header.entriesCount < 0) {
+            throw runtime_error("Invalid hub label file header.");
+        }
+        const size_t offsetsCount = 2 * size_t(header.nodesCount) + 1;
+        // The count of entries is checked against the file size first, so that the size of the entries cannot overflow
+        if (uint64_t(header.entriesCount) > file.getSize() / sizeof(HubLabelEntry)
+            || file.getSize() < sizeof(HubLabelFileHeader) + offsetsCount * sizeof(int64_t) + size_t(header.entriesCount) * sizeof(HubLabelEntry)) {
+            throw runtime_error("Hub label file is truncated.");
+        }
+        labels.nodesCount = header.nodesCount;
+        labels.offsets = reinterpret_cast<const int64_t*>(file.getData() + sizeof(HubLabelFileHeader));
+        labels.entries = reinterpret_cast<const HubLabelEntry*>(labels.offsets + offsetsCount);
+        // The queries merge the labels without bounds checks, stopping only at the end entries, so a corrupt file must not get past here
+        if (labels.offsets[0] != 0 || labels.offsets[2 * header.nodesCount] != header.entriesCount) {
+            throw runtime_error("Invalid hub label file offsets.");
+        }
+        for (size_t labelIdx = 0; labelIdx + 1 < offsetsCount; labelIdx++) {
+            const int64_t begin = labels.offsets[labelIdx];
+            const int64_t end = labels.offsets[labelIdx + 1];
+            // Every label has at least its end entry, so it is never empty
+            if (end <= begin || end > header.entriesCount) {
+                throw runtime_error("Invalid hub label file offsets.");
+            }
+            for (int64_t entryIdx = begin; entryIdx < end - 1; entryIdx++) {
+                if (labels.entries[entryIdx].hub < 0 || labels.entries[entryIdx].hub >= header.nodesCount) {
+                    throw runtime_error("Invalid hub label file hub.");
+                }
+            }
+            if (labels.entries[end - 1].hub != HUB_LABEL_END) {
+                throw runtime_error("Hub label file has a label without its end entry.");
+            }
+        }
+    }
+
+    HubLabelView view() const {
+        return labels;
+    }
+
+private:
+    MappedFile file;
+    HubLabelView labels;
+};
+
 // Prints the given path to the console as a list of nodes, separated with commas.
 void printPath(const vector<Node> &path) {
     for (int i = 0; i < path.size(); i++) {
@@ -69,7 +746,557 @@ void printPath(const vector<Node> &path) {
     cout << "\n";
 }
 
-int main() {
+// Runs a full BFS from each of the given start nodes and returns the total time in milliseconds.
+// The number of edges traversed is accumulated in edgesTraversed.
+template <typename GraphT>
+double timeFullBfs(const GraphT &graph, const vector<Node> &starts, long long &edgesTraversed) {
+    edgesTraversed = 0;
+    vector<Node> parent(graph.size());
+    Timer timer;
+    for (const Node start : starts) {
+        fill(parent.begin(), parent.end(), -1);
+        parent[start] = -2;
+        // A goal of -1 is never reached, so the whole reachable part of the graph is traversed
+        bfsCore(graph, start, -1, parent);
+        for (Node node = 0; node < int(graph.size()); node++) {
+            if (parent[node] != -1) {
+                edgesTraversed += graph[node].size();
+            }
+        }
+    }
+    return timer.elapsedMs();
+}
+
+// Compares BFS throughput on a random graph stored as nested vectors and as a CSR graph
+void benchCsr(int nodesCount, int avgDegree) {
+    cout << "BFS on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const vector< pair<Node, Node> > edges = generateRandomEdges(nodesCount, nodesCount * avgDegree);
+    const vector<Node> starts = generateRandomNodes(nodesCount, 10);
+
+    Timer buildTimer;
+    const Graph nestedGraph = buildAdjLists(nodesCount, edges);
+    const double nestedBuildMs = buildTimer.elapsedMs();
+    buildTimer.restart();
+    const CsrGraph<Node> csrGraph = buildCsr(nodesCount, edges);
+    const double csrBuildMs = buildTimer.elapsedMs();
+    cout << "  build nested: " << nestedBuildMs << " ms, build CSR: " << csrBuildMs << " ms\n";
+
+    long long edgesTraversed;
+    const double nestedMs = timeFullBfs(nestedGraph, starts, edgesTraversed);
+    printBenchResult("nested vectors", nestedMs, edgesTraversed);
+    const double csrMs = timeFullBfs(csrGraph, starts, edgesTraversed);
+    printBenchResult("CSR", csrMs, edgesTraversed);
+}
+
+// Compares the queue-based BFS with the direction-optimizing BFS on a random low-diameter graph
+void benchDirOpt(int nodesCount, int avgDegree) {
+    cout << "Direction-optimizing BFS on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const CsrGraph<Node> graph = buildCsr(nodesCount, generateRandomEdges(nodesCount, nodesCount * avgDegree));
+    const CsrGraph<Node> reverseGraph = buildReverseCsr(graph);
+    const vector<Node> starts = generateRandomNodes(nodesCount, 10);
+
+    long long edgesTraversed;
+    const double topDownMs = timeFullBfs(graph, starts, edgesTraversed);
+    printBenchResult("top-down", topDownMs, edgesTraversed);
+
+    vector<Node> parent(graph.size());
+    Timer timer;
+    for (const Node start : starts) {
+        fill(parent.begin(), parent.end(), -1);
+        parent[start] = -2;
+        bfsCoreDirOpt(graph, reverseGraph, start, -1, parent);
+    }
+    // Throughput is reported for the same edges as the top-down search, even though far fewer are actually checked
+    printBenchResult("direction-optimizing", timer.elapsedMs(), edgesTraversed);
+}
+
+// Runs a full parallel BFS from each of the given start nodes with 1 to maxThreads threads and prints the speedup
+void benchParallelOn(const char *graphName, const CsrGraph<Node> &graph, int maxThreads) {
+    cout << graphName << " with " << graph.size() << " nodes and " << graph.edgesCount() << " edges\n";
+    const vector<Node> starts = generateRandomNodes(graph.size(), 5);
+    vector< atomic<Node> > parent(graph.size());
+    double singleThreadMs = 0.0;
+    for (int threadsCount = 1; threadsCount <= maxThreads; threadsCount++) {
+        ThreadPool pool(threadsCount);
+        double totalMs = 0.0;
+        long long edgesTraversed = 0;
+        for (const Node start : starts) {
+            for (atomic<Node> &nodeParent : parent) {
+                nodeParent.store(-1, memory_order_relaxed);
+            }
+            parent[start] = -2;
+            Timer timer;
+            bfsCoreParallel(graph, start, -1, parent, pool);
+            totalMs += timer.elapsedMs();
+            for (Node node = 0; node < graph.size(); node++) {
+                if (parent[node].load(memory_order_relaxed) != -1) {
+                    edgesTraversed += graph.degree(node);
+                }
+            }
+        }
+        if (threadsCount == 1) {
+            singleThreadMs = totalMs;
+        }
+        cout << "  " << threadsCount << " threads: " << totalMs << " ms, "
+             << double(edgesTraversed) / (totalMs * 1000.0) << " MTEPS, speedup " << singleThreadMs / totalMs << "\n";
+    }
+}
+
+// Measures the scaling of the parallel BFS with the number of threads on an R-MAT graph and on a grid graph of similar size
+void benchParallel(int nodesCount, int avgDegree, int maxThreads) {
+    int scale = 1;
+    while ((1 << (scale + 1)) <= nodesCount) {
+        scale++;
+    }
+    benchParallelOn("R-MAT graph", buildCsr(1 << scale, generateRmatEdges(scale, (1 << scale) * avgDegree)), maxThreads);
+    int side = 1;
+    while ((side + 1) * (side + 1) <= nodesCount) {
+        side++;
+    }
+    benchParallelOn("Grid graph", buildCsr(side * side, generateGridEdges(side, side)), maxThreads);
+}
+
+// Compares the plain BFS with the bidirectional BFS on point-to-point queries between random nodes
+void benchBidirectional(int nodesCount, int avgDegree) {
+    cout << "Bidirectional BFS on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const CsrGraph<Node> graph = buildCsr(nodesCount, generateRandomEdges(nodesCount, nodesCount * avgDegree));
+    const CsrGraph<Node> reverseGraph = buildReverseCsr(graph);
+    const int queriesCount = 100;
+    const vector<Node> starts = generateRandomNodes(nodesCount, queriesCount, 2);
+    const vector<Node> goals = generateRandomNodes(nodesCount, queriesCount, 3);
+
+    vector<Node> parent(graph.size());
+    long long visitedCount = 0;
+    Timer timer;
+    for (int query = 0; query < queriesCount; query++) {
+        fill(parent.begin(), parent.end(), -1);
+        parent[starts[query]] = -2;
+        bfsCore(graph, starts[query], goals[query], parent);
+        visitedCount += graph.size() - count(parent.begin(), parent.end(), -1);
+    }
+    cout << "  one-directional: " << timer.elapsedMs() / queriesCount << " ms/query, " << visitedCount / queriesCount << " visited nodes/query\n";
+
+    vector<Node> backwardParent(graph.size());
+    visitedCount = 0;
+    timer.restart();
+    for (int query = 0; query < queriesCount; query++) {
+        fill(parent.begin(), parent.end(), -1);
+        fill(backwardParent.begin(), backwardParent.end(), -1);
+        parent[starts[query]] = -2;
+        backwardParent[goals[query]] = -2;
+        Node meetNode;
+        bfsCoreBidirectional(graph, reverseGraph, starts[query], goals[query], parent, backwardParent, meetNode);
+        visitedCount += 2 * graph.size() - count(parent.begin(), parent.end(), -1) - count(backwardParent.begin(), backwardParent.end(), -1);
+    }
+    cout << "  bidirectional: " << timer.elapsedMs() / queriesCount << " ms/query, " << visitedCount / queriesCount << " visited nodes/query\n";
+}
+
+// Compares answering many source-goal queries with a separate BFS per source and with the multi-source BFS
+void benchMsBfs(int nodesCount, int avgDegree) {
+    cout << "Multi-source BFS on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const CsrGraph<Node> graph = buildCsr(nodesCount, generateRandomEdges(nodesCount, nodesCount * avgDegree));
+    const vector<Node> sources = generateRandomNodes(nodesCount, MS_BFS_BATCH_SIZE, 2);
+    const vector<Node> goals = generateRandomNodes(nodesCount, MS_BFS_BATCH_SIZE, 3);
+
+    // A separate full BFS per source, reading the distances of the goals from the parent array
+    vector<int> singleDistances(sources.size() * goals.size(), -1);
+    vector<Node> parent(graph.size());
+    vector<Node> path;
+    Timer timer;
+    for (int srcIdx = 0; srcIdx < int(sources.size()); srcIdx++) {
+        fill(parent.begin(), parent.end(), -1);
+        parent[sources[srcIdx]] = -2;
+        bfsCore(graph, sources[srcIdx], -1, parent);
+        for (int goalIdx = 0; goalIdx < int(goals.size()); goalIdx++) {
+            if (parent[goals[goalIdx]] != -1) {
+                tracePath(parent, sources[srcIdx], goals[goalIdx], path);
+                singleDistances[srcIdx * goals.size() + goalIdx] = int(path.size()) - 1;
+            }
+        }
+    }
+    cout << "  " << sources.size() << " separate BFS: " << timer.elapsedMs() << " ms\n";
+
+    vector<int> distances;
+    timer.restart();
+    msBfs(graph, sources, goals, distances);
+    cout << "  one multi-source BFS: " << timer.elapsedMs() << " ms, "
+         << (distances == singleDistances ? "same distances" : "DIFFERENT distances") << "\n";
+}
+
+// Compares local queries, whose goal is two hops away from the start, with a fresh parent array per query and with a reused workspace
+void benchWorkspace(int nodesCount, int avgDegree) {
+    cout << "Local BFS queries on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const CsrGraph<Node> graph = buildCsr(nodesCount, generateRandomEdges(nodesCount, nodesCount * avgDegree));
+    const int queriesCount = 1000;
+    const vector<Node> starts = generateRandomNodes(nodesCount, queriesCount);
+    vector<Node> goals(queriesCount);
+    for (int query = 0; query < queriesCount; query++) {
+        // Go two hops away from the start through the last neighbours, if there are any
+        goals[query] = starts[query];
+        for (int hop = 0; hop < 2 && !graph[goals[query]].empty(); hop++) {
+            goals[query] = graph[goals[query]][graph.degree(goals[query]) - 1];
+        }
+    }
+
+    vector<Node> path;
+    int foundCount = 0;
+    Timer timer;
+    for (int query = 0; query < queriesCount; query++) {
+        foundCount += bfs(graph, starts[query], goals[query], path);
+    }
+    cout << "  fresh arrays: " << timer.elapsedMs() * 1000.0 / queriesCount << " us/query, " << foundCount << " found\n";
+
+    BfsWorkspace workspace(graph.size());
+    foundCount = 0;
+    timer.restart();
+    for (int query = 0; query < queriesCount; query++) {
+        foundCount += bfs(graph, starts[query], goals[query], path, workspace);
+    }
+    cout << "  reused workspace: " << timer.elapsedMs() * 1000.0 / queriesCount << " us/query, " << foundCount << " found\n";
+}
+
+// Returns the graph with its nodes randomly relabelled, to simulate node numbers that carry no locality
+CsrGraph<Node> shuffleNodes(const CsrGraph<Node> &graph, unsigned seed = 5) {
+    vector<Node> toOld(graph.size());
+    for (Node node = 0; node < graph.size(); node++) {
+        toOld[node] = node;
+    }
+    shuffle(toOld.begin(), toOld.end(), mt19937(seed));
+    return reorderGraph(graph, makeNodeOrder(toOld));
+}
+
+// Measures full BFS traversals from the same start nodes on the graph in its given order and in each locality order
+void benchReorderOn(const char *graphName, const CsrGraph<Node> &graph) {
+    cout << graphName << " with " << graph.size() << " nodes and " << graph.edgesCount() << " edges\n";
+    const vector<Node> starts = generateRandomNodes(graph.size(), 10);
+    long long edgesTraversed;
+    const double givenMs = timeFullBfs(graph, starts, edgesTraversed);
+    printBenchResult("given order", givenMs, edgesTraversed);
+
+    const char *orderNames[] = { "degree order", "BFS order", "RCM order" };
+    for (int orderIdx = 0; orderIdx < 3; orderIdx++) {
+        Timer timer;
+        const NodeOrder order = (orderIdx == 0) ? computeDegreeOrder(graph)
+                              : (orderIdx == 1) ? computeBfsOrder(graph)
+                              : computeRcmOrder(graph);
+        const CsrGraph<Node> reordered = reorderGraph(graph, order);
+        const double reorderMs = timer.elapsedMs();
+        // Start from the same original nodes, translated to the new numbering
+        vector<Node> newStarts(starts.size());
+        for (int idx = 0; idx < int(starts.size()); idx++) {
+            newStarts[idx] = order.toNew[starts[idx]];
+        }
+        const double bfsMs = timeFullBfs(reordered, newStarts, edgesTraversed);
+        printBenchResult(orderNames[orderIdx], bfsMs, edgesTraversed);
+        cout << "    reordering took " << reorderMs << " ms, speedup " << givenMs / bfsMs << "\n";
+    }
+}
+
+// Measures the BFS speedup from each locality order on a graph file, or on shuffled grid and R-MAT graphs if no file is given
+void benchReorder(int argc, char **argv) {
+    if (argc > 0 && strstr(argv[0], ".bin") != nullptr) {
+        const GraphFile file(argv[0]);
+        const CsrView view = file.graph();
+        CsrGraph<Node> graph;
+        graph.offsets.assign(view.offsets, view.offsets + view.size() + 1);
+        graph.targets.assign(view.targets, view.targets + view.edgesCount());
+        benchReorderOn(argv[0], graph);
+        return;
+    }
+    const int nodesCount = (argc > 0) ? atoi(argv[0]) : 1000000;
+    const int avgDegree = (argc > 1) ? atoi(argv[1]) : 8;
+    int side = 1;
+    while ((side + 1) * (side + 1) <= nodesCount) {
+        side++;
+    }
+    benchReorderOn("Shuffled grid graph", shuffleNodes(buildCsr(side * side, generateGridEdges(side, side))));
+    int scale = 1;
+    while ((1 << (scale + 1)) <= nodesCount) {
+        scale++;
+    }
+    benchReorderOn("Shuffled R-MAT graph", shuffleNodes(buildCsr(1 << scale, generateRmatEdges(scale, (1 << scale) * avgDegree))));
+}
+
+// Compares the size of a graph and the BFS throughput on it as a CSR graph and as a compressed graph
+void benchCompressedOn(const char *graphName, const CsrGraph<Node> &graph) {
+    cout << graphName << " with " << graph.size() << " nodes and " << graph.edgesCount() << " edges\n";
+    Timer timer;
+    const CompressedGraph compressed = compressGraph(graph);
+    const double compressMs = timer.elapsedMs();
+    const double csrBytes = double(sizeof(int) * (graph.offsets.size() + graph.targets.size()));
+    cout << "  CSR: " << csrBytes / graph.edgesCount() << " bytes/edge, compressed: " << double(compressed.sizeInBytes()) / graph.edgesCount()
+         << " bytes/edge, " << double(compressed.bytes.size()) / graph.edgesCount() << " of them for the neighbours, compressed in "
+         << compressMs << " ms\n";
+
+    const vector<Node> starts = generateRandomNodes(graph.size(), 10);
+    long long edgesTraversed;
+    const double csrMs = timeFullBfs(graph, starts, edgesTraversed);
+    printBenchResult("CSR", csrMs, edgesTraversed);
+    const double compressedMs = timeFullBfs(compressed, starts, edgesTraversed);
+    printBenchResult("compressed", compressedMs, edgesTraversed);
+    cout << "    slowdown " << compressedMs / csrMs << "\n";
+}
+
+// Measures the compression and the BFS slowdown on a random graph, where neighbours are far apart,
+// and on grid and R-MAT graphs in BFS order, where they are close
+void benchCompressed(int nodesCount, int avgDegree) {
+    benchCompressedOn("Random graph", buildCsr(nodesCount, generateRandomEdges(nodesCount, nodesCount * avgDegree)));
+    int side = 1;
+    while ((side + 1) * (side + 1) <= nodesCount) {
+        side++;
+    }
+    const CsrGraph<Node> grid = buildCsr(side * side, generateGridEdges(side, side));
+    benchCompressedOn("Grid graph in BFS order", reorderGraph(grid, computeBfsOrder(grid)));
+    int scale = 1;
+    while ((1 << (scale + 1)) <= nodesCount) {
+        scale++;
+    }
+    const CsrGraph<Node> rmat = buildCsr(1 << scale, generateRmatEdges(scale, (1 << scale) * avgDegree));
+    benchCompressedOn("R-MAT graph in BFS order", reorderGraph(rmat, computeBfsOrder(rmat)));
+}
+
+// Measures building hub labels for a random R-MAT graph and answering distance queries with them, compared with a BFS per query
+void benchHubLabels(int nodesCount, int avgDegree) {
+    int scale = 1;
+    while ((1 << (scale + 1)) <= nodesCount) {
+        scale++;
+    }
+    const CsrGraph<Node> graph = buildCsr(1 << scale, generateRmatEdges(scale, (1 << scale) * avgDegree));
+    cout << "Hub labels of an R-MAT graph with " << graph.size() << " nodes and " << graph.edgesCount() << " edges\n";
+    Timer timer;
+    const HubLabels labels = buildHubLabels(graph);
+    const HubLabelView view = labels.view();
+    cout << "  built in " << timer.elapsedMs() << " ms, " << double(view.labelEntriesCount()) / graph.size() << " entries per node, "
+         << view.sizeInBytes() / (1024.0 * 1024.0) << " MB\n";
+
+    const int queriesCount = 1000000;
+    const vector<Node> starts = generateRandomNodes(graph.size(), queriesCount, 2);
+    const vector<Node> goals = generateRandomNodes(graph.size(), queriesCount, 3);
+    int foundCount = 0;
+    timer.restart();
+    for (int query = 0; query < queriesCount; query++) {
+        foundCount += (hubLabelDistance(view, starts[query], goals[query]) != -1);
+    }
+    cout << "  label queries: " << timer.elapsedMs() * 1000000.0 / queriesCount << " ns/query, " << foundCount << " found\n";
+
+    // A BFS per query is much slower, so it runs on fewer queries, and its distances are compared with the labels
+    const int bfsQueriesCount = 1000;
+    BfsWorkspace workspace(graph.size());
+    vector<Node> path;
+    bool sameDistances = true;
+    timer.restart();
+    for (int query = 0; query < bfsQueriesCount; query++) {
+        const int bfsDist = (starts[query] == goals[query]) ? 0
+                          : bfs(graph, starts[query], goals[query], path, workspace) ? int(path.size()) - 1
+                          : -1;
+        sameDistances = sameDistances && (bfsDist == hubLabelDistance(view, starts[query], goals[query]));
+    }
+    cout << "  BFS queries: " << timer.elapsedMs() * 1000000.0 / bfsQueriesCount << " ns/query, "
+         << (sameDistances ? "same distances" : "DIFFERENT distances") << "\n";
+}
+
+// Runs the benchmark with the given name, with optional size parameters from the command line.
+// Returns false if there is no such benchmark.
+bool runBenchmark(const char *name, int argc, char **argv) {
+    const int nodesCount = (argc > 0) ? atoi(argv[0]) : 1000000;
+    const int avgDegree = (argc > 1) ? atoi(argv[1]) : 8;
+    if (strcmp(name, "csr") == 0) {
+        benchCsr(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "diropt") == 0) {
+        benchDirOpt(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "bidir") == 0) {
+        benchBidirectional(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "labels") == 0) {
+        // Building the labels of a large graph takes minutes, so the default graph is smaller than for the other benchmarks
+        benchHubLabels((argc > 0) ? nodesCount : 100000, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "msbfs") == 0) {
+        benchMsBfs(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "workspace") == 0) {
+        benchWorkspace(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "reorder") == 0) {
+        benchReorder(argc, argv);
+        return true;
+    }
+    if (strcmp(name, "compressed") == 0) {
+        benchCompressed(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "parallel") == 0) {
+        const int maxThreads = (argc > 2) ? atoi(argv[2]) : max(int(thread::hardware_concurrency()), 1);
+        benchParallel(nodesCount, avgDegree, maxThreads);
+        return true;
+    }
+    cout << "Unknown benchmark " << name << "\n";
+    return false;
+}
+
+// Searches a path between the given nodes of a graph loaded from a binary graph file and prints it.
+// Returns the exit code for main().
+int searchInGraphFile(const char *filepath, Node start, Node goal) {
+    try {
+        Timer timer;
+        const GraphFile file(filepath);
+        const auto graph = file.graph();
+        cout << "Loaded " << graph.size() << " nodes and " << graph.edgesCount() << " edges in " << timer.elapsedMs() << " ms\n";
+        if (start < 0 || start >= graph.size() || goal < 0 || goal >= graph.size()) {
+            cout << "Invalid start or goal node\n";
+            return 1;
+        }
+        vector<Node> path;
+        timer.restart();
+        const bool found = bfs(graph, start, goal, path);
+        cout << "Searched in " << timer.elapsedMs() << " ms\n";
+        if (found) {
+            cout << "Path found: ";
+            printPath(path);
+        }
+        else {
+            cout << "No path :(\n";
+        }
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Builds hub labels for a graph loaded from a binary graph file and writes them to a hub label file.
+// Returns the exit code for main().
+int writeHubLabelsForGraphFile(const char *graphFilepath, const char *labelFilepath) {
+    try {
+        const GraphFile file(graphFilepath);
+        const CsrView graph = file.graph();
+        Timer timer;
+        const HubLabels labels = buildHubLabels(graph);
+        const HubLabelView view = labels.view();
+        cout << "Built hub labels for " << graph.size() << " nodes in " << timer.elapsedMs() << " ms, "
+             << double(view.labelEntriesCount()) / max(graph.size(), 1) << " entries per node\n";
+        writeHubLabelFile(labelFilepath, view);
+        cout << "Written " << view.sizeInBytes() << " bytes\n";
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Prints the hop distance between the given nodes from a hub label file.
+// Returns the exit code for main().
+int hubDistanceFromFile(const char *labelFilepath, Node start, Node goal) {
+    try {
+        const HubLabelFile file(labelFilepath);
+        const HubLabelView labels = file.view();
+        if (start < 0 || start >= labels.nodesCount || goal < 0 || goal >= labels.nodesCount) {
+            cout << "Invalid start or goal node\n";
+            return 1;
+        }
+        const int dist = hubLabelDistance(labels, start, goal);
+        if (dist != -1) {
+            cout << "Distance: " << dist << "\n";
+        }
+        else {
+            cout << "No path :(\n";
+        }
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Serves queries on a graph loaded from a binary graph file, from stdin or from clients of a Unix socket if its path is given.
+// "bfs <start> <goal>" is answered with the length of the shortest path and its nodes, or -1, and "reach <start> <goal>" with 1 or 0.
+// Returns the exit code for main().
+int serveGraphFile(const char *filepath, int threadsCount, const char *socketPath) {
+    try {
+        Timer timer;
+        const GraphFile file(filepath);
+        const CsrView graph = file.graph();
+        ThreadPool pool(threadsCount);
+        // Every thread of the pool searches with its own workspace and path
+        vector<BfsWorkspace> workspaces(pool.size(), BfsWorkspace(graph.size()));
+        vector< vector<Node> > paths(pool.size());
+        const QueryAnswerer answer = [&](int threadIdx, const char *line, string &result) {
+            NodeQuery query;
+            if (!parseNodeQuery(line, graph.size(), query)) {
+                result += "error invalid query";
+                return;
+            }
+            const bool isPath = (strcmp(query.kind, "bfs") == 0);
+            if (!isPath && strcmp(query.kind, "reach") != 0) {
+                result += "error unknown query";
+                return;
+            }
+            vector<Node> &path = paths[threadIdx];
+            bool found = true;
+            if (query.start == query.goal) {
+                path.assign(1, query.start);
+            }
+            else {
+                found = bfs(graph, query.start, query.goal, path, workspaces[threadIdx]);
+            }
+            if (isPath) {
+                appendPathAnswer(result, found, int(path.size()) - 1, path);
+            }
+            else {
+                result += found ? '1' : '0';
+            }
+        };
+        // The answers go to stdout, so everything else goes to stderr
+        cerr << "Loaded " << graph.size() << " nodes and " << graph.edgesCount() << " edges in " << timer.elapsedMs() << " ms, serving with "
+             << pool.size() << " threads\n";
+        if (socketPath != nullptr) {
+            serveUnixSocket(socketPath, pool, answer);
+        }
+        else {
+            serveQueries(0, 1, pool, answer);
+        }
+    }
+    catch (const exception &e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    // Run a benchmark instead of the example if requested with "bench <name> [nodes | graph.bin] [degree] [threads]"
+    if (argc > 2 && strcmp(argv[1], "bench") == 0) {
+        return runBenchmark(argv[2], argc - 3, argv + 3) ? 0 : 1;
+    }
+    // Build hub labels for a graph file if requested with "labels <graph.bin> <output.bin>"
+    if (argc == 4 && strcmp(argv[1], "labels") == 0) {
+        return writeHubLabelsForGraphFile(argv[2], argv[3]);
+    }
+    // Find a distance with a hub label file if requested with "hubdist <labels.bin> <start> <goal>"
+    if (argc == 5 && strcmp(argv[1], "hubdist") == 0) {
+        return hubDistanceFromFile(argv[2], atoi(argv[3]), atoi(argv[4]));
+    }
+    // Serve queries on a graph file if requested with "serve <graph.bin> [threads] [socket path]"
+    if (argc > 2 && strcmp(argv[1], "serve") == 0) {
+        const int threadsCount = (argc > 3) ? atoi(argv[3]) : max(int(thread::hardware_concurrency()), 1);
+        return serveGraphFile(argv[2], threadsCount, (argc > 4) ? argv[4] : nullptr);
+    }
+    // Search in a graph file instead of the example graph if requested with "<graph.bin> <start> <goal>"
+    if (argc == 4) {
+        return searchInGraphFile(argv[1], atoi(argv[2]), atoi(argv[3]));
+    }
+
     // Create graph
     const Graph graph {
         { 1, 4 },
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <random>
+#include <chrono>
+using namespace std;
+
+typedef int Node;
+
+/// Simple stopwatch measuring wall-clock time since its creation or its last restart.
+struct Timer {
+    Timer() {
+        restart();
+    }
+
+    void restart() {
+        startTime = chrono::steady_clock::now();
+    }
+
+    double elapsedMs() const {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+    }
+
+private:
+    chrono::steady_clock::time_point startTime;
+};
+
+/// Returns a list of edges of a random directed graph, where the source and target of each edge are uniformly random.
+/// The same seed always gives the same graph, so that different layouts and algorithms can be compared on equal terms.
+inline vector< pair<Node, Node> > generateRandomEdges(int nodesCount, int edgesCount, unsigned seed = 1) {
+    mt19937 rng(seed);
+    uniform_int_distribution<Node> nodeDist(0, nodesCount - 1);
+    vector< pair<Node, Node> > edges(edgesCount);
+    for (pair<Node, Node> &edge : edges) {
+        edge = { nodeDist(rng), nodeDist(rng) };
+    }
+    return edges;
+}
+
+/// Returns a list of edges of a random R-MAT graph with 2^scale nodes, which has a skewed degree distribution and a small diameter like social graphs.
+/// Each edge is placed by recursively choosing one of the four quadrants of the adjacency matrix with probabilities a, b, c and 1 - a - b - c.
+inline vector< pair<Node, Node> > generateRmatEdges(int scale, int edgesCount, unsigned seed = 1, double a = 0.57, double b = 0.19, double c = 0.19) {
+    mt19937 rng(seed);
+    uniform_real_distribution<double> probDist(0.0, 1.0);
+    vector< pair<Node, Node> > edges(edgesCount);
+    for (pair<Node, Node> &edge : edges) {
+        Node source = 0;
+        Node target = 0;
+        for (int bit = 0; bit < scale; bit++) {
+            const double prob = probDist(rng);
+            const bool sourceBit = (prob >= a + b);
+            const bool targetBit = (prob >= a && prob < a + b) || (prob >= a + b + c);
+            source |= Node(sourceBit) << bit;
+            target |= Node(targetBit) << bit;
+        }
+        edge = { source, target };
+    }
+    return edges;
+}
+
+/// Returns a list of edges of a 4-connected width x height grid graph with edges in both directions,
+/// which has a large diameter like road networks. The node of cell (row, col) is row * width + col.
+inline vector< pair<Node, Node> > generateGridEdges(int width, int height) {
+    vector< pair<Node, Node> > edges;
+    edges.reserve(size_t(width) * height * 4);
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            const Node node = row * width + col;
+            if (col + 1 < width) {
+                edges.push_back({ node, node + 1 });
+                edges.push_back({ node + 1, node });
+            }
+            if (row + 1 < height) {
+                edges.push_back({ node, node + width });
+                edges.push_back({ node + width, node });
+            }
+        }
+    }
+    return edges;
+}
+
+/// Returns a list of random nodes to be used as query sources or goals in benchmarks.
+inline vector<Node> generateRandomNodes(int nodesCount, int count, unsigned seed = 2) {
+    mt19937 rng(seed);
+    uniform_int_distribution<Node> nodeDist(0, nodesCount - 1);
+    vector<Node> nodes(count);
+    for (Node &node : nodes) {
+        node = nodeDist(rng);
+    }
+    return nodes;
+}
+
+/// Prints a single benchmark result line with the time taken and the throughput in millions of traversed edges per second.
+inline void printBenchResult(const char *name, double timeMs, long long edgesTraversed) {
+    const double mteps = (timeMs > 0.0) ? double(edgesTraversed) / (timeMs * 1000.0) : 0.0;
+    cout << "  " << name << ": " << timeMs << " ms, " << mteps << " MTEPS\n";
+}
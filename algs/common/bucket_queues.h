@@ -0,0 +1,184 @@
+#pragma once
+
+#include <vector>
+#include "csr_graph.h"
+using namespace std;
+
+// Both queues below are monotone: a pushed key must never be smaller than the last popped key,
+// which always holds in Dijkstra with non-negative integer weights. Only a key pushed into an empty queue may be smaller,
+// and the keys start over from it, so the same queue can be reused for the next search.
+// They have the same members as IndexedDaryHeap, so either can be given to dijkstraCore() as its queue policy.
+// Lowering the key of a node pushes a new entry, and the entry with the old key is recognized as stale
+// and skipped when it comes up, by comparing with the current key of the node.
+
+/// Monotone radix heap for non-negative integer keys, where each operation takes amortized O(1) time for keys up to 2^32.
+/// Bucket i holds the entries whose key differs from the last popped key first at bit i - 1, and bucket 0 the ones equal to it.
+/// Popping from an empty bucket 0 takes the minimum of the first non-empty bucket as the new last key
+/// and spreads that bucket into lower buckets, so every entry moves down at most 32 times in total.
+struct RadixHeap {
+    RadixHeap(int nodesCount)
+        : currentKey(nodesCount, -1)
+    {}
+
+    bool empty() const {
+        return nodesInQueue == 0;
+    }
+
+    void pushOrDecrease(Node node, int key) {
+        if (nodesInQueue == 0 && unsigned(key) < lastKey) {
+            lastKey = key;
+        }
+        if (currentKey[node] == -1) {
+            nodesInQueue++;
+        }
+        currentKey[node] = key;
+        buckets[bucketOf(unsigned(key))].push_back({ unsigned(key), node });
+    }
+
+    Node popMin() {
+        while (true) {
+            // A bucket of only stale entries refills nothing, so keep going to the next one
+            while (buckets[0].empty()) {
+                refillBucketZero();
+            }
+            const Entry entry = buckets[0].back();
+            buckets[0].pop_back();
+            if (isCurrent(entry)) {
+                currentKey[entry.node] = -1;
+                nodesInQueue--;
+                // Only stale entries can be left, so drop them before they get mixed with the keys of the next search
+                if (nodesInQueue == 0) {
+                    clear();
+                }
+                return entry.node;
+            }
+        }
+    }
+
+    void clear() {
+        for (vector<Entry> &bucket : buckets) {
+            for (const Entry &entry : bucket) {
+                currentKey[entry.node] = -1;
+            }
+            bucket.clear();
+        }
+        nodesInQueue = 0;
+    }
+
+private:
+    static const int BUCKETS_COUNT = 33;
+
+    struct Entry {
+        unsigned key;
+        Node node;
+    };
+
+    bool isCurrent(const Entry &entry) const {
+        return currentKey[entry.node] == int(entry.key);
+    }
+
+    // Returns the index of the highest bit where the key differs from the last popped key, plus one
+    int bucketOf(unsigned key) const {
+        const unsigned diff = key ^ lastKey;
+        return (diff == 0) ? 0 : 32 - __builtin_clz(diff);
+    }
+
+    // Moves the entries of the first non-empty bucket to lower buckets around its minimum key
+    void refillBucketZero() {
+        int bucketIdx = 1;
+        while (buckets[bucketIdx].empty()) {
+            bucketIdx++;
+        }
+        vector<Entry> &bucket = buckets[bucketIdx];
+        // Stale entries are dropped here, so they do not lower the new last key
+        unsigned minKey = ~0u;
+        for (const Entry &entry : bucket) {
+            if (isCurrent(entry) && entry.key < minKey) {
+                minKey = entry.key;
+            }
+        }
+        if (minKey != ~0u) {
+            lastKey = minKey;
+        }
+        for (const Entry &entry : bucket) {
+            if (isCurrent(entry)) {
+                buckets[bucketOf(entry.key)].push_back(entry);
+            }
+        }
+        bucket.clear();
+    }
+
+    vector<Entry> buckets[BUCKETS_COUNT];
+    vector<int> currentKey;
+    unsigned lastKey = 0;
+    int nodesInQueue = 0;
+};
+
+/// Dial's bucket queue for integer keys when every edge weight is at most MaxEdgeWeight.
+/// All keys in the queue are then within MaxEdgeWeight of the last popped key, so a circular array of
+/// MaxEdgeWeight + 1 buckets, one per key, holds them all, and pushing is O(1) and popping is O(MaxEdgeWeight) at worst.
+template <int MaxEdgeWeight>
+struct DialQueue {
+    DialQueue(int nodesCount)
+        : currentKey(nodesCount, -1)
+        , buckets(MaxEdgeWeight + 1)
+    {}
+
+    bool empty() const {
+        return nodesInQueue == 0;
+    }
+
+    void pushOrDecrease(Node node, int key) {
+        if (nodesInQueue == 0 && key < lastKey) {
+            lastKey = key;
+        }
+        if (currentKey[node] == -1) {
+            nodesInQueue++;
+        }
+        currentKey[node] = key;
+        buckets[key % (MaxEdgeWeight + 1)].push_back({ key, node });
+    }
+
+    Node popMin() {
+        while (true) {
+            vector<Entry> &bucket = buckets[lastKey % (MaxEdgeWeight + 1)];
+            // Go to the next key once the bucket of the current one is used up
+            if (bucket.empty()) {
+                lastKey++;
+                continue;
+            }
+            const Entry entry = bucket.back();
+            bucket.pop_back();
+            if (currentKey[entry.node] == entry.key) {
+                currentKey[entry.node] = -1;
+                nodesInQueue--;
+                // Only stale entries can be left, so drop them before they get mixed with the keys of the next search
+                if (nodesInQueue == 0) {
+                    clear();
+                }
+                return entry.node;
+            }
+        }
+    }
+
+    void clear() {
+        for (vector<Entry> &bucket : buckets) {
+            for (const Entry &entry : bucket) {
+                currentKey[entry.node] = -1;
+            }
+            bucket.clear();
+        }
+        nodesInQueue = 0;
+    }
+
+private:
+    struct Entry {
+        int key;
+        Node node;
+    };
+
+    vector<int> currentKey;
+    vector< vector<Entry> > buckets;
+    int lastKey = 0;
+    int nodesInQueue = 0;
+};
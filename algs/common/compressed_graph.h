@@ -0,0 +1,168 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "csr_graph.h"
+using namespace std;
+
+// Neighbour lists are stored as variable-length integers, 7 bits in each byte, where the high bit of a byte
+// is set if more bytes of the same number follow. Small numbers take a single byte.
+
+/// Appends the value to the bytes as a variable-length integer
+inline void appendVarint(vector<uint8_t> &bytes, uint32_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(uint8_t(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(uint8_t(value));
+}
+
+/// Reads a variable-length integer from the given bytes into value and returns a pointer to the byte after it
+inline const uint8_t* readVarint(const uint8_t *data, uint32_t &value) {
+    // Most gaps between sorted neighbours fit in a single byte, so that case is checked first
+    if (data[0] < 0x80) {
+        value = data[0];
+        return data + 1;
+    }
+    value = data[0] & 0x7f;
+    int shift = 7;
+    data++;
+    while (*data >= 0x80) {
+        value |= uint32_t(*data & 0x7f) << shift;
+        shift += 7;
+        data++;
+    }
+    value |= uint32_t(*data) << shift;
+    return data + 1;
+}
+
+/// Iterator that decodes the neighbours of a single node of a CompressedGraph one at a time, as it is advanced.
+/// It only goes forward, so it supports range-based for loops, but not indexing.
+struct CompressedNeighbourIterator {
+    // Encoding of the current neighbour, the one after it, and the end of the list
+    const uint8_t *pos;
+    const uint8_t *next;
+    const uint8_t *last;
+    Node curr;
+
+    Node operator*() const {
+        return curr;
+    }
+
+    CompressedNeighbourIterator& operator++() {
+        pos = next;
+        if (pos != last) {
+            uint32_t gap;
+            next = readVarint(pos, gap);
+            curr += Node(gap);
+        }
+        return *this;
+    }
+
+    bool operator==(const CompressedNeighbourIterator &other) const {
+        return pos == other.pos;
+    }
+
+    bool operator!=(const CompressedNeighbourIterator &other) const {
+        return pos != other.pos;
+    }
+};
+
+/// Neighbours of a single node of a CompressedGraph.
+/// It behaves like the inner vector of a vector< vector<Node> > graph in range-based for loops.
+struct CompressedRange {
+    Node node;
+    const uint8_t *first;
+    const uint8_t *last;
+
+    CompressedNeighbourIterator begin() const {
+        CompressedNeighbourIterator it { first, first, last, node };
+        // The first neighbour is stored as its difference from the node itself, which can be negative
+        if (first != last) {
+            uint32_t code;
+            it.next = readVarint(first, code);
+            it.curr = Node(int64_t(node) + ((code & 1) ? -int64_t(code >> 1) - 1 : int64_t(code >> 1)));
+        }
+        return it;
+    }
+
+    CompressedNeighbourIterator end() const {
+        return { last, last, last, 0 };
+    }
+
+    /// Returns the number of neighbours, by counting the last bytes of their encodings, without decoding them
+    int size() const {
+        int count = 0;
+        for (const uint8_t *byte = first; byte != last; byte++) {
+            count += (*byte < 0x80);
+        }
+        return count;
+    }
+
+    bool empty() const {
+        return first == last;
+    }
+};
+
+/// Unweighted graph with compressed neighbour lists, for graphs too large to keep in memory as a CsrGraph<Node>.
+/// The neighbours of each node are sorted and stored as the gaps between consecutive ones, as variable-length integers,
+/// and the first one as its difference from the node. Graphs where neighbours have close numbers, like the ones
+/// relabelled with an order from graph_reorder.h, then take one or two bytes per edge instead of four.
+/// The neighbours are decoded on the fly while a search traverses them, so functions that take any graph
+/// with size() and operator[], like bfsCore() and dfsCore(), work on it unchanged, but see the neighbours in sorted order.
+struct CompressedGraph {
+    // Byte offsets of the neighbour lists of the nodes, which can go beyond the range of int for huge graphs
+    vector<int64_t> offsets = { 0 };
+    vector<uint8_t> bytes;
+    int totalEdges = 0;
+
+    /// Returns the number of nodes, same as size() of a vector< vector<Node> > graph
+    int size() const {
+        return int(offsets.size()) - 1;
+    }
+
+    int edgesCount() const {
+        return totalEdges;
+    }
+
+    /// Returns the neighbours of the given node, same as operator[] of a vector< vector<Node> > graph
+    CompressedRange operator[](Node node) const {
+        const uint8_t *data = bytes.data();
+        return { node, data + offsets[node], data + offsets[node + 1] };
+    }
+
+    /// Returns the memory taken by the graph, for comparison with the 4 bytes per edge and per node of a CsrGraph<Node>
+    size_t sizeInBytes() const {
+        return offsets.size() * sizeof(int64_t) + bytes.size();
+    }
+};
+
+/// Builds a compressed graph from any graph with size() and operator[], like a Graph, a CsrGraph<Node> or a CsrView.
+template <typename GraphT>
+CompressedGraph compressGraph(const GraphT &graph) {
+    CompressedGraph compressed;
+    compressed.offsets.resize(graph.size() + 1);
+    compressed.offsets[0] = 0;
+    vector<Node> neighs;
+    for (Node node = 0; node < int(graph.size()); node++) {
+        neighs.clear();
+        for (const Node neigh : graph[node]) {
+            neighs.push_back(neigh);
+        }
+        sort(neighs.begin(), neighs.end());
+        for (int idx = 0; idx < int(neighs.size()); idx++) {
+            if (idx == 0) {
+                // Zig-zag encoding maps differences 0, -1, 1, -2, ... to 0, 1, 2, 3, ... so that small ones of both signs stay short
+                const int64_t diff = int64_t(neighs[0]) - node;
+                appendVarint(compressed.bytes, uint32_t((diff >= 0) ? 2 * diff : -2 * diff - 1));
+            }
+            else {
+                appendVarint(compressed.bytes, uint32_t(neighs[idx] - neighs[idx - 1]));
+            }
+        }
+        compressed.offsets[node + 1] = int64_t(compressed.bytes.size());
+        compressed.totalEdges += int(neighs.size());
+    }
+    return compressed;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+using namespace std;
+
+typedef int Node;
+
+/// Contiguous range of the neighbours of a single node in a CSR graph.
+/// It behaves like the inner vector of a vector< vector<Target> > graph, so it can be traversed with a range-based for.
+template <typename Target>
+struct CsrRange {
+    const Target *first;
+    const Target *last;
+
+    const Target* begin() const {
+        return first;
+    }
+
+    const Target* end() const {
+        return last;
+    }
+
+    int size() const {
+        return int(last - first);
+    }
+
+    bool empty() const {
+        return first == last;
+    }
+
+    const Target& operator[](int idx) const {
+        return first[idx];
+    }
+};
+
+/// Graph in compressed sparse row layout.
+/// The neighbours of all nodes are stored one after another in a single targets array,
+/// and the neighbours of node i are the ones in the range [offsets[i], offsets[i + 1]).
+/// Target is the type of a single neighbour, Node for unweighted graphs and Edge for weighted ones.
+template <typename Target>
+struct CsrGraph {
+    vector<int> offsets = { 0 };
+    vector<Target> targets;
+
+    /// Returns the number of nodes, same as size() of a vector< vector<Target> > graph
+    int size() const {
+        return int(offsets.size()) - 1;
+    }
+
+    int edgesCount() const {
+        return int(targets.size());
+    }
+
+    int degree(Node node) const {
+        return offsets[node + 1] - offsets[node];
+    }
+
+    /// Returns the neighbours of the given node, same as operator[] of a vector< vector<Target> > graph
+    CsrRange<Target> operator[](Node node) const {
+        const Target *data = targets.data();
+        return { data + offsets[node], data + offsets[node + 1] };
+    }
+};
+
+/// Builds a CSR graph with the given number of nodes from a list of (source, target) edges.
+/// The neighbours of each node keep the order in which their edges appear in the list.
+template <typename Target>
+CsrGraph<Target> buildCsr(int nodesCount, const vector< pair<Node, Target> > &edges) {
+    CsrGraph<Target> graph;
+    // Count the out-degree of each node, shifted by one so that the prefix sum gives the offsets directly
+    graph.offsets.assign(nodesCount + 1, 0);
+    for (const pair<Node, Target> &edge : edges) {
+        graph.offsets[edge.first + 1]++;
+    }
+    for (int node = 0; node < nodesCount; node++) {
+        graph.offsets[node + 1] += graph.offsets[node];
+    }
+    // Place each edge at the next free position in the range of its source node
+    graph.targets.resize(edges.size());
+    vector<int> nextPos(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (const pair<Node, Target> &edge : edges) {
+        graph.targets[nextPos[edge.first]++] = edge.second;
+    }
+    return graph;
+}
+
+/// Builds a CSR graph from a graph stored as a vector of adjacency lists, keeping the order of neighbours.
+template <typename Target>
+CsrGraph<Target> buildCsr(const vector< vector<Target> > &adjLists) {
+    CsrGraph<Target> graph;
+    graph.offsets.resize(adjLists.size() + 1);
+    graph.offsets[0] = 0;
+    for (int node = 0; node < int(adjLists.size()); node++) {
+        graph.offsets[node + 1] = graph.offsets[node] + int(adjLists[node].size());
+    }
+    graph.targets.reserve(graph.offsets.back());
+    for (const vector<Target> &neighs : adjLists) {
+        graph.targets.insert(graph.targets.end(), neighs.begin(), neighs.end());
+    }
+    return graph;
+}
+
+/// Builds a graph stored as a vector of adjacency lists from a list of (source, target) edges.
+template <typename Target>
+vector< vector<Target> > buildAdjLists(int nodesCount, const vector< pair<Node, Target> > &edges) {
+    vector< vector<Target> > adjLists(nodesCount);
+    for (const pair<Node, Target> &edge : edges) {
+        adjLists[edge.first].push_back(edge.second);
+    }
+    return adjLists;
+}
+
+/// Returns the node a neighbour entry points to. Weighted graphs provide their own overload for their edge type.
+inline Node targetNode(Node target) {
+    return target;
+}
+
+/// Returns a copy of the neighbour entry that points to the given node instead, used for reversing and relabelling edges.
+/// Weighted graphs provide their own overload for their edge type, which keeps the weight of the original edge.
+inline Node retarget(Node, Node node) {
+    return node;
+}
+
+/// Builds the reverse graph, in which every edge (u, v) of the given graph becomes (v, u).
+/// The neighbours of each node in the reverse graph are its in-neighbours in the original graph, ordered by source node.
+template <typename Target>
+CsrGraph<Target> buildReverseCsr(const CsrGraph<Target> &graph) {
+    const int nodesCount = graph.size();
+    CsrGraph<Target> reverse;
+    // Count the in-degree of each node, shifted by one so that the prefix sum gives the offsets directly
+    reverse.offsets.assign(nodesCount + 1, 0);
+    for (const Target &target : graph.targets) {
+        reverse.offsets[targetNode(target) + 1]++;
+    }
+    for (int node = 0; node < nodesCount; node++) {
+        reverse.offsets[node + 1] += reverse.offsets[node];
+    }
+    // Place each reversed edge at the next free position in the range of its new source node
+    reverse.targets.resize(graph.targets.size());
+    vector<int> nextPos(reverse.offsets.begin(), reverse.offsets.end() - 1);
+    for (Node node = 0; node < nodesCount; node++) {
+        for (const Target &target : graph[node]) {
+            reverse.targets[nextPos[targetNode(target)]++] = retarget(target, node);
+        }
+    }
+    return reverse;
+}
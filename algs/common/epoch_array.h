@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+/// Array where every element starts with the same default value, and which can be reset back to it in O(1).
+/// Each element carries the epoch it was last written in, and elements from an older epoch read as the default value.
+/// This lets a workspace kept across queries pay only for the elements a query actually touches,
+/// instead of initializing an array over the whole graph before every query.
+template <typename T>
+struct EpochArray {
+    EpochArray(int size, const T &defaultValue)
+        : values(size, defaultValue)
+        , stamps(size, 0)
+        , defaultValue(defaultValue)
+    {}
+
+    int size() const {
+        return int(values.size());
+    }
+
+    /// Returns a reference to the element, which is first set to the default value if it was not touched in the current epoch
+    T& operator[](int idx) {
+        if (stamps[idx] != epoch) {
+            stamps[idx] = epoch;
+            values[idx] = defaultValue;
+        }
+        return values[idx];
+    }
+
+    /// Returns the value of the element without touching it
+    T operator[](int idx) const {
+        return (stamps[idx] == epoch) ? values[idx] : defaultValue;
+    }
+
+    /// Sets all elements back to the default value
+    void reset() {
+        epoch++;
+        // When the epoch counter wraps around, old stamps could be mistaken for current ones, so clear them for real
+        if (epoch == 0) {
+            fill(stamps.begin(), stamps.end(), 0);
+            epoch = 1;
+        }
+    }
+
+private:
+    vector<T> values;
+    vector<unsigned> stamps;
+    T defaultValue;
+    unsigned epoch = 1;
+};
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include "csr_graph.h"
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+using namespace std;
+
+/// Binary graph file layout, all values are 32-bit integers in the native byte order:
+///   header            GraphFileHeader
+///   offsets           nodesCount + 1 values, the CSR offsets
+///   targets           edgesCount values, the target node of each edge
+///   weights           edgesCount values, the weight of each edge, only if hasWeights is set
+/// Every array starts at a multiple of 4 bytes, so the mapped file can be used in place without any parsing or copying.
+struct GraphFileHeader {
+    char magic[4];
+    int version;
+    int nodesCount;
+    int edgesCount;
+    int hasWeights;
+    int reserved;
+};
+
+const char GRAPH_FILE_MAGIC[4] = { 'F', 'M', 'I', 'G' };
+const int GRAPH_FILE_VERSION = 1;
+
+/// Read-only memory mapping of a whole file, unmapped when destroyed.
+struct MappedFile {
+    MappedFile(const char *filepath) {
+#ifdef _WIN32
+        fileHandle = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            throw runtime_error("Cannot open graph file.");
+        }
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(fileHandle, &fileSize);
+        size = size_t(fileSize.QuadPart);
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle == nullptr) {
+            CloseHandle(fileHandle);
+            throw runtime_error("Cannot map graph file.");
+        }
+        data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr) {
+            CloseHandle(mappingHandle);
+            CloseHandle(fileHandle);
+            throw runtime_error("Cannot map graph file.");
+        }
+#else
+        const int fd = open(filepath, O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error("Cannot open graph file.");
+        }
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0) {
+            close(fd);
+            throw runtime_error("Cannot read size of graph file.");
+        }
+        size = size_t(fileStat.st_size);
+        data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        // The mapping stays valid after the file descriptor is closed
+        close(fd);
+        if (data == MAP_FAILED) {
+            throw runtime_error("Cannot map graph file.");
+        }
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+#else
+        munmap(data, size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* getData() const {
+        return static_cast<const char*>(data);
+    }
+
+    size_t getSize() const {
+        return size;
+    }
+
+private:
+    void *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#endif
+};
+
+/// Unweighted view of a CSR graph stored in memory that it does not own, like a mapped graph file.
+/// It provides the same size() and operator[] as CsrGraph<Node>, so the templated algorithms can run on it directly.
+struct CsrView {
+    int nodesCount = 0;
+    const int *offsets = nullptr;
+    const Node *targets = nullptr;
+
+    int size() const {
+        return nodesCount;
+    }
+
+    int edgesCount() const {
+        return offsets[nodesCount];
+    }
+
+    int degree(Node node) const {
+        return offsets[node + 1] - offsets[node];
+    }
+
+    CsrRange<Node> operator[](Node node) const {
+        return { targets + offsets[node], targets + offsets[node + 1] };
+    }
+};
+
+/// Range over the edges of a single node of a WeightedCsrView, combining each target with its weight into an EdgeT on the fly.
+template <typename EdgeT>
+struct WeightedCsrRange {
+    struct Iterator {
+        const Node *target;
+        const int *weight;
+
+        EdgeT operator*() const {
+            return { *target, *weight };
+        }
+
+        Iterator& operator++() {
+            ++target;
+            ++weight;
+            return *this;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return target != other.target;
+        }
+    };
+
+    Iterator first;
+    Iterator last;
+
+    Iterator begin() const {
+        return first;
+    }
+
+    Iterator end() const {
+        return last;
+    }
+
+    int size() const {
+        return int(last.target - first.target);
+    }
+
+    bool empty() const {
+        return first.target == last.target;
+    }
+
+    EdgeT operator[](int idx) const {
+        return { first.target[idx], first.weight[idx] };
+    }
+};
+
+/// Weighted view of a CSR graph stored in memory that it does not own, with targets and weights in separate arrays.
+/// EdgeT must be constructible as { node, weight }. It provides the same size() and operator[] as CsrGraph<EdgeT>.
+template <typename EdgeT>
+struct WeightedCsrView {
+    int nodesCount = 0;
+    const int *offsets = nullptr;
+    const Node *targets = nullptr;
+    const int *weights = nullptr;
+
+    int size() const {
+        return nodesCount;
+    }
+
+    int edgesCount() const {
+        return offsets[nodesCount];
+    }
+
+    int degree(Node node) const {
+        return offsets[node + 1] - offsets[node];
+    }
+
+    WeightedCsrRange<EdgeT> operator[](Node node) const {
+        const int begin = offsets[node];
+        const int end = offsets[node + 1];
+        return { { targets + begin, weights + begin }, { targets + end, weights + end } };
+    }
+};
+
+/// Graph file mapped into memory. The graph views point directly into the mapping, so they are valid while the GraphFile lives.
+struct GraphFile {
+    GraphFile(const char *filepath)
+        : file(filepath)
+    {
+        if (file.getSize() < sizeof(GraphFileHeader)) {
+            throw runtime_error("Graph file is too small.");
+        }
+        memcpy(&header, file.getData(), sizeof(GraphFileHeader));
+        if (memcmp(header.magic, GRAPH_FILE_MAGIC, sizeof(GRAPH_FILE_MAGIC)) != 0 || header.version != GRAPH_FILE_VERSION
+            || header.nodesCount < 0 || header.edgesCount < 0) {
+            throw runtime_error("Invalid graph file header.");
+        }
+        const size_t arraysCount = size_t(header.nodesCount) + 1 + size_t(header.edgesCount) * (header.hasWeights ? 2 : 1);
+        if (file.getSize() < sizeof(GraphFileHeader) + arraysCount * sizeof(int)) {
+            throw runtime_error("Graph file is truncated.");
+        }
+        offsets = reinterpret_cast<const int*>(file.getData() + sizeof(GraphFileHeader));
+        targets = offsets + header.nodesCount + 1;
+        weights = header.hasWeights ? targets + header.edgesCount : nullptr;
+        // The views are used without bounds checks, so a corrupt file must not get past here
+        if (offsets[0] != 0 || offsets[header.nodesCount] != header.edgesCount) {
+            throw runtime_error("Invalid graph file offsets.");
+        }
+        for (Node node = 0; node < header.nodesCount; node++) {
+            if (offsets[node + 1] < offsets[node]) {
+                throw runtime_error("Invalid graph file offsets.");
+            }
+        }
+        for (int edgeIdx = 0; edgeIdx < header.edgesCount; edgeIdx++) {
+            if (targets[edgeIdx] < 0 || targets[edgeIdx] >= header.nodesCount) {
+                throw runtime_error("Invalid graph file edge target.");
+            }
+        }
+    }
+
+    int nodesCount() const {
+        return header.nodesCount;
+    }
+
+    int edgesCount() const {
+        return header.edgesCount;
+    }
+
+    bool hasWeights() const {
+        return header.hasWeights != 0;
+    }
+
+    /// Returns an unweighted view of the graph, which ignores the weights if there are any
+    CsrView graph() const {
+        return { header.nodesCount, offsets, targets };
+    }
+
+    /// Returns a weighted view of the graph, the file must have weights
+    template <typename EdgeT>
+    WeightedCsrView<EdgeT> weightedGraph() const {
+        if (!hasWeights()) {
+            throw runtime_error("Graph file has no weights.");
+        }
+        return { header.nodesCount, offsets, targets, weights };
+    }
+
+private:
+    MappedFile file;
+    GraphFileHeader header;
+    const int *offsets = nullptr;
+    const Node *targets = nullptr;
+    const int *weights = nullptr;
+};
+
+/// Writes a graph file from CSR arrays. The weights are written only if they are not empty.
+inline void writeGraphFile(const char *filepath, const vector<int> &offsets, const vector<Node> &targets, const vector<int> &weights) {
+    if (!weights.empty() && weights.size() != targets.size()) {
+        throw runtime_error("Graph weights do not match the edges.");
+    }
+    FILE *file = fopen(filepath, "wb");
+    if (file == nullptr) {
+        throw runtime_error("Cannot open graph file for writing.");
+    }
+    GraphFileHeader header;
+    memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(GRAPH_FILE_MAGIC));
+    header.version = GRAPH_FILE_VERSION;
+    header.nodesCount = int(offsets.size()) - 1;
+    header.edgesCount = int(targets.size());
+    header.hasWeights = weights.empty() ? 0 : 1;
+    header.reserved = 0;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    written = written && fwrite(offsets.data(), sizeof(int), offsets.size(), file) == offsets.size();
+    written = written && fwrite(targets.data(), sizeof(Node), targets.size(), file) == targets.size();
+    written = written && fwrite(weights.data(), sizeof(int), weights.size(), file) == weights.size();
+    if (fclose(file) != 0 || !written) {
+        throw runtime_error("Cannot write graph file.");
+    }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include "csr_graph.h"
+using namespace std;
+
+/// Relabelling of the nodes of a graph, kept in both directions so that queries can be translated
+/// from the original node numbering to the reordered graph and their results translated back.
+struct NodeOrder {
+    vector<Node> toNew;
+    vector<Node> toOld;
+};
+
+// Returns the node order that puts the given old nodes at positions 0, 1, 2, ... of the new numbering
+inline NodeOrder makeNodeOrder(const vector<Node> &toOld) {
+    NodeOrder order;
+    order.toOld = toOld;
+    order.toNew.resize(toOld.size());
+    for (Node newNode = 0; newNode < int(toOld.size()); newNode++) {
+        order.toNew[toOld[newNode]] = newNode;
+    }
+    return order;
+}
+
+/// Builds the undirected version of a graph as a plain list of neighbour nodes, with both the out- and the in-neighbours of each node.
+/// The orderings work on it, so that nodes connected in either direction end up close to each other.
+template <typename GraphT>
+CsrGraph<Node> buildUndirectedGraph(const GraphT &graph) {
+    vector< pair<Node, Node> > edges;
+    for (Node node = 0; node < int(graph.size()); node++) {
+        for (const auto &target : graph[node]) {
+            edges.push_back({ node, targetNode(target) });
+            edges.push_back({ targetNode(target), node });
+        }
+    }
+    return buildCsr(int(graph.size()), edges);
+}
+
+/// Orders nodes by decreasing degree, so that the hub nodes that most edges point to are packed together at the start.
+template <typename GraphT>
+NodeOrder computeDegreeOrder(const GraphT &graph) {
+    const CsrGraph<Node> undirected = buildUndirectedGraph(graph);
+    vector<Node> toOld(graph.size());
+    for (Node node = 0; node < int(graph.size()); node++) {
+        toOld[node] = node;
+    }
+    stable_sort(toOld.begin(), toOld.end(), [&](Node aNode, Node bNode) {
+        return undirected.degree(aNode) > undirected.degree(bNode);
+    });
+    return makeNodeOrder(toOld);
+}
+
+/// Orders nodes in the order a BFS visits them, restarting from the first unvisited node for each connected component,
+/// so that the nodes of each BFS level are numbered consecutively.
+template <typename GraphT>
+NodeOrder computeBfsOrder(const GraphT &graph) {
+    const CsrGraph<Node> undirected = buildUndirectedGraph(graph);
+    vector<Node> toOld;
+    toOld.reserve(graph.size());
+    vector<bool> visited(graph.size(), false);
+    for (Node root = 0; root < int(graph.size()); root++) {
+        if (visited[root]) {
+            continue;
+        }
+        // The order list itself serves as the BFS queue, starting at the first node of this component
+        visited[root] = true;
+        toOld.push_back(root);
+        for (int queueIdx = int(toOld.size()) - 1; queueIdx < int(toOld.size()); queueIdx++) {
+            for (const Node neigh : undirected[toOld[queueIdx]]) {
+                if (!visited[neigh]) {
+                    visited[neigh] = true;
+                    toOld.push_back(neigh);
+                }
+            }
+        }
+    }
+    return makeNodeOrder(toOld);
+}
+
+/// Orders nodes with the reverse Cuthill-McKee algorithm, which keeps the neighbours of each node within a narrow band of numbers.
+/// It is a BFS that starts each component from a node of minimum degree and visits the new neighbours of each node
+/// by increasing degree, and the final order is reversed.
+template <typename GraphT>
+NodeOrder computeRcmOrder(const GraphT &graph) {
+    const CsrGraph<Node> undirected = buildUndirectedGraph(graph);
+    const int nodesCount = int(graph.size());
+    // Nodes by increasing degree, to pick the start of each component
+    vector<Node> byDegree(nodesCount);
+    for (Node node = 0; node < nodesCount; node++) {
+        byDegree[node] = node;
+    }
+    const auto lessDegree = [&](Node aNode, Node bNode) {
+        return undirected.degree(aNode) < undirected.degree(bNode);
+    };
+    stable_sort(byDegree.begin(), byDegree.end(), lessDegree);
+
+    vector<Node> toOld;
+    toOld.reserve(nodesCount);
+    vector<bool> visited(nodesCount, false);
+    for (const Node root : byDegree) {
+        if (visited[root]) {
+            continue;
+        }
+        visited[root] = true;
+        toOld.push_back(root);
+        for (int queueIdx = int(toOld.size()) - 1; queueIdx < int(toOld.size()); queueIdx++) {
+            const int newBegin = int(toOld.size());
+            for (const Node neigh : undirected[toOld[queueIdx]]) {
+                if (!visited[neigh]) {
+                    visited[neigh] = true;
+                    toOld.push_back(neigh);
+                }
+            }
+            stable_sort(toOld.begin() + newBegin, toOld.end(), lessDegree);
+        }
+    }
+    reverse(toOld.begin(), toOld.end());
+    return makeNodeOrder(toOld);
+}
+
+/// Returns a copy of the graph with its nodes relabelled by the given order.
+/// Node i of the new graph is node order.toOld[i] of the old one, with the same neighbours in the same order, relabelled too.
+template <typename Target>
+CsrGraph<Target> reorderGraph(const CsrGraph<Target> &graph, const NodeOrder &order) {
+    CsrGraph<Target> reordered;
+    reordered.offsets.resize(graph.offsets.size());
+    reordered.targets.reserve(graph.targets.size());
+    reordered.offsets[0] = 0;
+    for (Node newNode = 0; newNode < graph.size(); newNode++) {
+        for (const Target &target : graph[order.toOld[newNode]]) {
+            reordered.targets.push_back(retarget(target, order.toNew[targetNode(target)]));
+        }
+        reordered.offsets[newNode + 1] = int(reordered.targets.size());
+    }
+    return reordered;
+}
+
+/// Translates a path found in a reordered graph back to the node numbering of the original graph.
+inline void pathToOldNodes(const NodeOrder &order, vector<Node> &path) {
+    for (Node &node : path) {
+        node = order.toOld[node];
+    }
+}
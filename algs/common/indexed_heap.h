@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+#include "csr_graph.h"
+using namespace std;
+
+/// Min-heap of nodes keyed by their tentative distance, where every node of the heap has D children.
+/// The position of every node in the heap is kept in an index, so a node is never in the heap twice,
+/// and lowering the key of a node that is already in it moves it up in place instead of pushing a duplicate.
+/// A 4-ary heap is shallower than a binary one and keeps the children of a node in a single cache line.
+///
+/// It is the default queue policy of dijkstraCore(). Every queue policy provides the same members:
+///   Queue(int nodesCount)                       an empty queue for nodes in [0, nodesCount)
+///   bool empty() const
+///   void pushOrDecrease(Node node, int key)     adds the node, or lowers its key if it is already in the queue
+///   Node popMin()                               removes and returns a node with the smallest key
+///   void clear()                                removes all nodes, in time proportional to their number
+template <int D = 4>
+struct IndexedDaryHeap {
+    IndexedDaryHeap(int nodesCount)
+        : position(nodesCount, -1)
+    {}
+
+    bool empty() const {
+        return entries.empty();
+    }
+
+    int size() const {
+        return int(entries.size());
+    }
+
+    bool contains(Node node) const {
+        return position[node] != -1;
+    }
+
+    void pushOrDecrease(Node node, int key) {
+        int idx = position[node];
+        if (idx == -1) {
+            idx = int(entries.size());
+            entries.push_back({ key, node });
+        }
+        else {
+            entries[idx].key = key;
+        }
+        siftUp(idx);
+    }
+
+    Node popMin() {
+        const Node minNode = entries[0].node;
+        position[minNode] = -1;
+        const Entry last = entries.back();
+        entries.pop_back();
+        if (!entries.empty()) {
+            entries[0] = last;
+            position[last.node] = 0;
+            siftDown(0);
+        }
+        return minNode;
+    }
+
+    void clear() {
+        for (const Entry &entry : entries) {
+            position[entry.node] = -1;
+        }
+        entries.clear();
+    }
+
+private:
+    struct Entry {
+        int key;
+        Node node;
+    };
+
+    // Moves the entry at the given index up while it has a smaller key than its parent
+    void siftUp(int idx) {
+        const Entry entry = entries[idx];
+        while (idx > 0) {
+            const int parentIdx = (idx - 1) / D;
+            if (entries[parentIdx].key <= entry.key) {
+                break;
+            }
+            entries[idx] = entries[parentIdx];
+            position[entries[idx].node] = idx;
+            idx = parentIdx;
+        }
+        entries[idx] = entry;
+        position[entry.node] = idx;
+    }
+
+    // Moves the entry at the given index down while one of its children has a smaller key
+    void siftDown(int idx) {
+        const Entry entry = entries[idx];
+        const int count = int(entries.size());
+        while (true) {
+            const int firstChild = idx * D + 1;
+            if (firstChild >= count) {
+                break;
+            }
+            const int lastChild = (firstChild + D < count) ? firstChild + D : count;
+            int minChild = firstChild;
+            for (int child = firstChild + 1; child < lastChild; child++) {
+                if (entries[child].key < entries[minChild].key) {
+                    minChild = child;
+                }
+            }
+            if (entry.key <= entries[minChild].key) {
+                break;
+            }
+            entries[idx] = entries[minChild];
+            position[entries[idx].node] = idx;
+            idx = minChild;
+        }
+        entries[idx] = entry;
+        position[entry.node] = idx;
+    }
+
+    vector<Entry> entries;
+    vector<int> position;
+};
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <stdexcept>
+#include <functional>
+#include "csr_graph.h"
+#include "thread_pool.h"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+using namespace std;
+
+// Maximum number of queries answered together as one parallel batch
+const int QUERY_BATCH_MAX_SIZE = 4096;
+// Number of queries of a batch a thread takes at once
+const int QUERY_BATCH_CHUNK_SIZE = 16;
+
+/// Writer that collects small writes to a file descriptor in a buffer and writes them with a single system call when it is full
+/// or when flushed, as a system call per answer line would cost more than answering most queries.
+struct BufferedWriter {
+    BufferedWriter(int fd, size_t capacity = 1 << 16)
+        : fd(fd)
+    {
+        buffer.reserve(capacity);
+    }
+
+    ~BufferedWriter() {
+        // A destructor must not throw, and an error here means the reader is gone anyway
+        try {
+            flush();
+        }
+        catch (const exception&) {
+        }
+    }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    void write(const char *data, size_t size) {
+        if (buffer.size() + size > buffer.capacity()) {
+            flush();
+        }
+        buffer.insert(buffer.end(), data, data + size);
+    }
+
+    void write(const string &text) {
+        write(text.data(), text.size());
+    }
+
+    void flush() {
+        size_t written = 0;
+        while (written < buffer.size()) {
+#ifdef _WIN32
+            const int count = _write(fd, buffer.data() + written, unsigned(buffer.size() - written));
+#else
+            const ssize_t count = ::write(fd, buffer.data() + written, buffer.size() - written);
+#endif
+            if (count <= 0) {
+                buffer.clear();
+                throw runtime_error("Cannot write query answers.");
+            }
+            written += size_t(count);
+        }
+        buffer.clear();
+    }
+
+private:
+    int fd;
+    vector<char> buffer;
+};
+
+/// Reader of lines from a file descriptor, which reads the input in large blocks and hands out all complete lines of each block together.
+struct LineReader {
+    LineReader(int fd)
+        : fd(fd)
+        , buffer(1 << 16)
+    {}
+
+    /// Waits for input and fills lines with the complete lines that have arrived, up to maxLines of them, without their line ends.
+    /// The lines point into the reader's buffer and are valid until the next call. A last line without a line end is returned
+    /// when the input ends. Returns false when the input has ended and all lines were returned.
+    bool readLines(vector<char*> &lines, int maxLines) {
+        lines.clear();
+        // Keep only the part of the buffer after the lines returned last time, which may be the beginning of a line
+        memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+        filled -= consumed;
+        consumed = 0;
+        while (true) {
+            while (int(lines.size()) < maxLines) {
+                char *lineBegin = buffer.data() + consumed;
+                char *lineEnd = static_cast<char*>(memchr(lineBegin, '\n', filled - consumed));
+                if (lineEnd == nullptr) {
+                    break;
+                }
+                *lineEnd = '\0';
+                if (lineEnd > lineBegin && lineEnd[-1] == '\r') {
+                    lineEnd[-1] = '\0';
+                }
+                lines.push_back(lineBegin);
+                consumed = size_t(lineEnd + 1 - buffer.data());
+            }
+            if (!lines.empty()) {
+                return true;
+            }
+            if (ended) {
+                if (consumed == filled) {
+                    return false;
+                }
+                buffer[filled] = '\0';
+                lines.push_back(buffer.data() + consumed);
+                consumed = filled;
+                return true;
+            }
+            // A single line longer than the buffer needs a bigger one, and one byte is always kept free for the end of a last line
+            if (filled + 1 >= buffer.size()) {
+                buffer.resize(buffer.size() * 2);
+            }
+#ifdef _WIN32
+            const int count = _read(fd, buffer.data() + filled, unsigned(buffer.size() - filled - 1));
+#else
+            const ssize_t count = read(fd, buffer.data() + filled, buffer.size() - filled - 1);
+#endif
+            if (count <= 0) {
+                ended = true;
+            }
+            else {
+                filled += size_t(count);
+            }
+        }
+    }
+
+private:
+    int fd;
+    vector<char> buffer;
+    // Bytes of input in the buffer, and how many of them were already returned as lines
+    size_t filled = 0;
+    size_t consumed = 0;
+    bool ended = false;
+};
+
+/// Answers a single query line, appending the answer without a line end to the result.
+/// It is called concurrently from all threads of the pool, with the index of the calling thread for its own workspaces.
+typedef function<void(int, const char*, string&)> QueryAnswerer;
+
+/// Reads queries from the input, one per line, and writes an answer line for each to the output, in the same order.
+/// The queries that arrive together are answered as one batch in parallel on the pool, and the answers of a batch
+/// are written together, so a client that sends many queries at once gets both the parallelism and few system calls.
+/// Empty lines are skipped. Returns when the input ends.
+inline void serveQueries(int inputFd, int outputFd, ThreadPool &pool, const QueryAnswerer &answer) {
+    LineReader reader(inputFd);
+    BufferedWriter writer(outputFd);
+    vector<char*> lines;
+    // The answer strings are reused across batches, so they keep their memory
+    vector<string> answers(QUERY_BATCH_MAX_SIZE);
+    while (reader.readLines(lines, QUERY_BATCH_MAX_SIZE)) {
+        pool.parallelFor(int(lines.size()), QUERY_BATCH_CHUNK_SIZE, [&](int threadIdx, int begin, int end) {
+            for (int idx = begin; idx < end; idx++) {
+                answers[idx].clear();
+                if (lines[idx][0] != '\0') {
+                    answer(threadIdx, lines[idx], answers[idx]);
+                }
+            }
+        });
+        for (int idx = 0; idx < int(lines.size()); idx++) {
+            if (lines[idx][0] != '\0') {
+                writer.write(answers[idx]);
+                writer.write("\n", 1);
+            }
+        }
+        writer.flush();
+    }
+}
+
+/// Listens on a Unix socket at the given path and serves the queries of each client with serveQueries(), one client after another,
+/// until the process is stopped. A client that disconnects in the middle only ends its own connection.
+inline void serveUnixSocket(const char *socketPath, ThreadPool &pool, const QueryAnswerer &answer) {
+#ifdef _WIN32
+    throw runtime_error("Unix sockets are not supported on this platform.");
+#else
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        throw runtime_error("Socket path is too long.");
+    }
+    strcpy(address.sun_path, socketPath);
+    const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        throw runtime_error("Cannot create socket.");
+    }
+    // A socket file left from an earlier run would make bind fail
+    unlink(socketPath);
+    if (bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, 16) != 0) {
+        close(listenFd);
+        throw runtime_error("Cannot listen on socket.");
+    }
+    // Writing to a client that is gone should fail the write, not kill the server
+    signal(SIGPIPE, SIG_IGN);
+    while (true) {
+        const int clientFd = accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            continue;
+        }
+        try {
+            serveQueries(clientFd, clientFd, pool, answer);
+        }
+        catch (const exception&) {
+        }
+        close(clientFd);
+    }
+#endif
+}
+
+/// Query of the form "<kind> <start> <goal>", like "bfs 3 17"
+struct NodeQuery {
+    char kind[16];
+    Node start;
+    Node goal;
+};
+
+/// Parses a query line of the form "<kind> <start> <goal>". Returns false if the line has another form or a node out of [0, nodesCount).
+inline bool parseNodeQuery(const char *line, int nodesCount, NodeQuery &query) {
+    return sscanf(line, "%15s %d %d", query.kind, &query.start, &query.goal) == 3
+        && query.start >= 0 && query.start < nodesCount && query.goal >= 0 && query.goal < nodesCount;
+}
+
+/// Appends the answer to a path query: the length of the path followed by its nodes, separated with spaces, or -1 if there is no path.
+inline void appendPathAnswer(string &result, bool found, long long length, const vector<Node> &path) {
+    char number[24];
+    if (!found) {
+        result += "-1";
+        return;
+    }
+    result.append(number, to_chars(number, number + sizeof(number), length).ptr);
+    for (const Node node : path) {
+        result += ' ';
+        result.append(number, to_chars(number, number + sizeof(number), node).ptr);
+    }
+}
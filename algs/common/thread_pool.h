@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+using namespace std;
+
+/// Pool of worker threads for fork-join parallelism.
+/// The threads are created once and then reused for every parallel step, which matters for level-synchronous
+/// algorithms that run a short parallel step per level. The calling thread takes part in the work as thread 0.
+struct ThreadPool {
+    ThreadPool(int threadsCount)
+        : threadsCount(max(threadsCount, 1))
+    {
+        for (int threadIdx = 1; threadIdx < this->threadsCount; threadIdx++) {
+            workers.emplace_back([this, threadIdx]() { workerLoop(threadIdx); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stopping = true;
+            generation++;
+        }
+        wakeCond.notify_all();
+        for (thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const {
+        return threadsCount;
+    }
+
+    /// Runs task(threadIdx) on every thread of the pool, with threadIdx in [0, size()), and waits for all of them to finish.
+    void runOnAll(const function<void(int)> &task) {
+        if (threadsCount == 1) {
+            task(0);
+            return;
+        }
+        {
+            lock_guard<mutex> lock(mtx);
+            currentTask = &task;
+            pendingCount = threadsCount - 1;
+            generation++;
+        }
+        wakeCond.notify_all();
+        task(0);
+        unique_lock<mutex> lock(mtx);
+        doneCond.wait(lock, [this]() { return pendingCount == 0; });
+        currentTask = nullptr;
+    }
+
+    /// Calls body(threadIdx, begin, end) for consecutive chunks of [0, count) with at most chunkSize elements each.
+    /// Chunks are handed out dynamically, so threads that finish early take over the remaining work.
+    void parallelFor(int count, int chunkSize, const function<void(int, int, int)> &body) {
+        atomic<int> nextBegin(0);
+        runOnAll([&](int threadIdx) {
+            while (true) {
+                const int begin = nextBegin.fetch_add(chunkSize);
+                if (begin >= count) {
+                    break;
+                }
+                body(threadIdx, begin, min(begin + chunkSize, count));
+            }
+        });
+    }
+
+private:
+    void workerLoop(int threadIdx) {
+        unsigned seenGeneration = 0;
+        while (true) {
+            const function<void(int)> *task;
+            {
+                unique_lock<mutex> lock(mtx);
+                wakeCond.wait(lock, [&]() { return generation != seenGeneration; });
+                seenGeneration = generation;
+                if (stopping) {
+                    return;
+                }
+                task = currentTask;
+            }
+            (*task)(threadIdx);
+            {
+                lock_guard<mutex> lock(mtx);
+                pendingCount--;
+            }
+            doneCond.notify_one();
+        }
+    }
+
+    int threadsCount;
+    vector<thread> workers;
+    mutex mtx;
+    condition_variable wakeCond;
+    condition_variable doneCond;
+    const function<void(int)> *currentTask = nullptr;
+    unsigned generation = 0;
+    int pendingCount = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <random>
+#include <algorithm>
+using namespace std;
+
+/// Pool of threads for irregular recursive work, where tasks spawn more tasks of unpredictable size.
+/// Every thread has its own deque of tasks. It pushes and pops its own tasks at the back, so it keeps working depth-first
+/// on the most recent ones, and when it runs out it steals the oldest task from the front of another thread's deque,
+/// which is usually the biggest piece of remaining work.
+template <typename Task>
+struct WorkStealingPool {
+    WorkStealingPool(int threadsCount)
+        : queues(max(threadsCount, 1))
+    {}
+
+    int size() const {
+        return int(queues.size());
+    }
+
+    /// Processes the initial tasks and all tasks spawned from them with process(threadIdx, task), and returns when all are done.
+    void run(const vector<Task> &initialTasks, const function<void(int, Task&)> &process) {
+        pendingCount = int(initialTasks.size());
+        // Deal the initial tasks round-robin, so every thread has something to start with
+        for (int taskIdx = 0; taskIdx < int(initialTasks.size()); taskIdx++) {
+            queues[taskIdx % size()].tasks.push_back(initialTasks[taskIdx]);
+        }
+        vector<thread> workers;
+        for (int threadIdx = 1; threadIdx < size(); threadIdx++) {
+            workers.emplace_back([this, threadIdx, &process]() { workerLoop(threadIdx, process); });
+        }
+        workerLoop(0, process);
+        for (thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    /// Adds a new task to the deque of the given thread. Must be called from inside process() on that thread.
+    void spawn(int threadIdx, const Task &task) {
+        pendingCount.fetch_add(1);
+        lock_guard<mutex> lock(queues[threadIdx].mtx);
+        queues[threadIdx].tasks.push_back(task);
+    }
+
+private:
+    struct TaskQueue {
+        mutex mtx;
+        deque<Task> tasks;
+    };
+
+    bool popOwn(int threadIdx, Task &task) {
+        lock_guard<mutex> lock(queues[threadIdx].mtx);
+        if (queues[threadIdx].tasks.empty()) {
+            return false;
+        }
+        task = queues[threadIdx].tasks.back();
+        queues[threadIdx].tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int victimIdx, Task &task) {
+        lock_guard<mutex> lock(queues[victimIdx].mtx);
+        if (queues[victimIdx].tasks.empty()) {
+            return false;
+        }
+        task = queues[victimIdx].tasks.front();
+        queues[victimIdx].tasks.pop_front();
+        return true;
+    }
+
+    void workerLoop(int threadIdx, const function<void(int, Task&)> &process) {
+        mt19937 rng(threadIdx + 1);
+        uniform_int_distribution<int> victimDist(0, size() - 1);
+        Task task;
+        // A task is counted as pending until it is fully processed, so a zero count means no task can spawn new ones anymore
+        while (pendingCount.load() > 0) {
+            bool found = popOwn(threadIdx, task);
+            for (int attempt = 0; !found && attempt < 2 * size(); attempt++) {
+                const int victimIdx = victimDist(rng);
+                found = (victimIdx != threadIdx) && steal(victimIdx, task);
+            }
+            if (!found) {
+                this_thread::yield();
+                continue;
+            }
+            process(threadIdx, task);
+            pendingCount.fetch_sub(1);
+        }
+    }
+
+    vector<TaskQueue> queues;
+    atomic<int> pendingCount{ 0 };
+};
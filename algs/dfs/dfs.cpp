@@ -1,12 +1,41 @@
 #include <iostream>
 #include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <random>
+#include "../common/csr_graph.h"
+#include "../common/epoch_array.h"
+#include "../common/compressed_graph.h"
+#include "../common/graph_file.h"
+#include "../common/bench.h"
+#include "../common/work_stealing_pool.h"
+#include "../common/query_server.h"
 using namespace std;
 
 typedef int Node;
 
 typedef vector< vector<Node> > Graph;
 
-bool dfsCore(const Graph &graph, vector<bool> &visited, int start, int goal, vector<int> &path) {
+/// What the DFS does with the nodes it backtracks from.
+enum DfsMode {
+    // Nodes stay visited once they are backtracked from, because the goal cannot be reached through them anyway.
+    // Every node and edge is traversed at most once, so the search takes O(V + E) time.
+    DFS_REACHABILITY,
+    // Nodes are marked unvisited again when backtracked from, so that they can be tried again as part of another path.
+    // This goes through all simple paths from the start until one reaches the goal, which takes exponential time in the worst case.
+    DFS_ALL_SIMPLE_PATHS
+};
+
+/// The graph can be either a Graph or a CsrGraph<Node>, both provide size() and operator[] for the neighbours of a node.
+/// The visited array can be either a vector<bool> or the EpochArray<char> of a DfsWorkspace.
+template <typename GraphT, typename VisitedArray>
+bool dfsCore(const GraphT &graph, VisitedArray &visited, int start, int goal, vector<int> &path, DfsMode mode = DFS_REACHABILITY) {
     // Add start node to path and mark it as visited
     path.push_back(start);
     visited[start] = true;
@@ -17,22 +46,481 @@ bool dfsCore(const Graph &graph, vector<bool> &visited, int start, int goal, vec
     // Traverse neighbours of the start node
     for (int neigh : graph[start]) {
         // Recursively perform DFS on each unvisited neighbour
-        if (!visited[neigh] && dfsCore(graph, visited, neigh, goal, path)) {
+        if (!visited[neigh] && dfsCore(graph, visited, neigh, goal, path, mode)) {
             // If the goal is reached through any of them, we are done
             return true;
         }
     }
-    // At this point no path is found, so remove start node from path and mark it as unvisited
+    // At this point no path is found, so remove start node from path
     path.pop_back();
-    visited[start] = false;
+    // and mark it as unvisited if other paths through it should still be tried
+    if (mode == DFS_ALL_SIMPLE_PATHS) {
+        visited[start] = false;
+    }
     return false;
 }
 
-/// Depth-first search a path from start node to goal node of the given graph.
+/// Frame of the explicit DFS stack, with the node and the index of its next neighbour to try
+struct DfsFrame {
+    Node node;
+    int nextNeighIdx;
+};
+
+/// Iterative version of dfsCore() with an explicit stack instead of recursion, so the depth is limited only by memory,
+/// not by the size of the thread stack. It tries neighbours in the same order, so it finds the same path as dfsCore().
+/// The stack is passed in so that its memory can be reused across searches.
+template <typename GraphT, typename VisitedArray>
+bool dfsCoreIterative(const GraphT &graph, VisitedArray &visited, int start, int goal, vector<int> &path,
+                      vector<DfsFrame> &stack, DfsMode mode = DFS_REACHABILITY) {
+    stack.clear();
+    stack.push_back({ start, 0 });
+    visited[start] = true;
+    while (!stack.empty() && stack.back().node != goal) {
+        const Node curr = stack.back().node;
+        const auto &neighs = graph[curr];
+        // Skip the neighbours that are already visited
+        int &neighIdx = stack.back().nextNeighIdx;
+        while (neighIdx < int(neighs.size()) && visited[neighs[neighIdx]]) {
+            neighIdx++;
+        }
+        if (neighIdx < int(neighs.size())) {
+            // Go deeper into the next unvisited neighbour, which is tried after the ones before it have failed
+            const Node neigh = neighs[neighIdx++];
+            visited[neigh] = true;
+            stack.push_back({ neigh, 0 });
+        }
+        else {
+            // All neighbours have failed, so backtrack from the current node
+            stack.pop_back();
+            if (mode == DFS_ALL_SIMPLE_PATHS) {
+                visited[curr] = false;
+            }
+        }
+    }
+    if (stack.empty()) {
+        return false;
+    }
+    // The nodes left on the stack form the path from the start to the goal
+    for (const DfsFrame &frame : stack) {
+        path.push_back(frame.node);
+    }
+    return true;
+}
+
+/// Depth-first search a path from start node to goal node of the given graph with an explicit stack, safe on very deep graphs.
 /// The function returns true if a path is found, and fills the path vector with it.
-bool dfs(const Graph &graph, int start, int goal, vector<int> &path) {
+template <typename GraphT>
+bool dfsIterative(const GraphT &graph, int start, int goal, vector<int> &path, DfsMode mode = DFS_REACHABILITY) {
     vector<bool> visited(graph.size(), false);
-    return dfsCore(graph, visited, start, goal, path);
+    vector<DfsFrame> stack;
+    return dfsCoreIterative(graph, visited, start, goal, path, stack, mode);
+}
+
+/// Depth-first search a path from start node to goal node of the given graph.
+/// It runs the iterative search, so it is safe on the deep paths of huge graphs, and finds the same path as dfsCore().
+/// The function returns true if a path is found, and fills the path vector with it.
+template <typename GraphT>
+bool dfs(const GraphT &graph, int start, int goal, vector<int> &path, DfsMode mode = DFS_REACHABILITY) {
+    return dfsIterative(graph, start, goal, path, mode);
+}
+
+/// Memory for DFS queries that is kept by the caller and reused across queries on graphs with the same number of nodes.
+/// Resetting it is O(1), so a query that touches only a few nodes of a huge graph costs only as much as those nodes.
+struct DfsWorkspace {
+    DfsWorkspace(int nodesCount)
+        : visited(nodesCount, false)
+    {}
+
+    EpochArray<char> visited;
+    vector<DfsFrame> stack;
+};
+
+/// Depth-first search a path from start node to goal node of the given graph, reusing the given workspace.
+/// It uses the explicit stack of the workspace, so it is safe on very deep graphs and finds the same path as dfs().
+/// The function returns true if a path is found, and fills the path vector with it.
+template <typename GraphT>
+bool dfs(const GraphT &graph, int start, int goal, vector<int> &path, DfsWorkspace &workspace, DfsMode mode = DFS_REACHABILITY) {
+    workspace.visited.reset();
+    path.clear();
+    return dfsCoreIterative(graph, workspace.visited, start, goal, path, workspace.stack, mode);
+}
+
+/// Callback for every path found by the enumeration, called with the index of the thread that found it.
+/// It is called concurrently from all threads of the enumeration, so it must be thread-safe.
+typedef function<void(int, const vector<Node>&)> PathCallback;
+
+// Number of edges of the path prefixes that get split into separate tasks of the parallel enumeration.
+// Deeper splitting gives more and smaller tasks, which balance better but cost more to schedule.
+const int PATHS_SPLIT_DEPTH = 3;
+
+// Extends the path in every possible way with nodes not on it yet, up to the maximum number of edges,
+// and reports each extension that reaches the goal. Nodes on the path are marked in the visited array.
+template <typename GraphT>
+void extendSimplePaths(const GraphT &graph, vector<char> &visited, vector<Node> &path, Node goal, int maxLength,
+                       int threadIdx, const PathCallback &onPath, long long &pathsCount) {
+    const Node curr = path.back();
+    // A simple path to the goal ends at the goal, it cannot go through it and come back
+    if (curr == goal) {
+        onPath(threadIdx, path);
+        pathsCount++;
+        return;
+    }
+    if (int(path.size()) - 1 >= maxLength) {
+        return;
+    }
+    for (const Node neigh : graph[curr]) {
+        if (!visited[neigh]) {
+            visited[neigh] = true;
+            path.push_back(neigh);
+            extendSimplePaths(graph, visited, path, goal, maxLength, threadIdx, onPath, pathsCount);
+            path.pop_back();
+            visited[neigh] = false;
+        }
+    }
+}
+
+/// Enumerates all simple paths from start node to goal node with at most maxLength edges, calling onPath for each of them.
+/// The search tree is split into a task per path prefix of splitDepth edges, and the tasks run on a work-stealing pool,
+/// so threads that finish their part early take over the remaining prefixes of the others.
+/// The paths are passed to the callback as they are found and are not kept. Returns the number of paths found.
+template <typename GraphT>
+long long enumerateSimplePaths(const GraphT &graph, Node start, Node goal, int maxLength, int threadsCount,
+                               const PathCallback &onPath, int splitDepth = PATHS_SPLIT_DEPTH) {
+    WorkStealingPool< vector<Node> > pool(threadsCount);
+    vector< vector<char> > threadVisited(pool.size(), vector<char>(graph.size(), false));
+    vector<long long> threadPathsCount(pool.size(), 0);
+    pool.run({ { start } }, [&](int threadIdx, vector<Node> &prefix) {
+        vector<char> &visited = threadVisited[threadIdx];
+        for (const Node node : prefix) {
+            visited[node] = true;
+        }
+        const int prefixLength = int(prefix.size()) - 1;
+        if (prefix.back() != goal && prefixLength < splitDepth && prefixLength < maxLength) {
+            // Still shallow, so make a separate task for each way to extend the prefix
+            for (const Node neigh : graph[prefix.back()]) {
+                if (!visited[neigh]) {
+                    prefix.push_back(neigh);
+                    pool.spawn(threadIdx, prefix);
+                    prefix.pop_back();
+                }
+            }
+        }
+        else {
+            extendSimplePaths(graph, visited, prefix, goal, maxLength, threadIdx, onPath, threadPathsCount[threadIdx]);
+        }
+        for (const Node node : prefix) {
+            visited[node] = false;
+        }
+    });
+    long long pathsCount = 0;
+    for (const long long count : threadPathsCount) {
+        pathsCount += count;
+    }
+    return pathsCount;
+}
+
+/// Writes paths found by several threads to a file, one line of comma-separated nodes per path.
+/// Each thread collects its paths in its own buffer, which is written to the file only when it gets full,
+/// so the threads rarely wait for each other and the paths are never all in memory at once.
+struct PathFileWriter {
+    PathFileWriter(const char *filepath, int threadsCount)
+        : buffers(threadsCount)
+    {
+        file = fopen(filepath, "w");
+        if (file == nullptr) {
+            throw runtime_error("Cannot open paths file for writing.");
+        }
+    }
+
+    ~PathFileWriter() {
+        for (string &buffer : buffers) {
+            fwrite(buffer.data(), 1, buffer.size(), file);
+        }
+        fclose(file);
+    }
+
+    PathFileWriter(const PathFileWriter&) = delete;
+    PathFileWriter& operator=(const PathFileWriter&) = delete;
+
+    void write(int threadIdx, const vector<Node> &path) {
+        string &buffer = buffers[threadIdx];
+        for (int i = 0; i < int(path.size()); i++) {
+            buffer += to_string(path[i]);
+            buffer += (i + 1 < int(path.size())) ? ',' : '\n';
+        }
+        if (buffer.size() >= PATHS_BUFFER_SIZE) {
+            lock_guard<mutex> lock(fileMtx);
+            fwrite(buffer.data(), 1, buffer.size(), file);
+            buffer.clear();
+        }
+    }
+
+private:
+    static const size_t PATHS_BUFFER_SIZE = 1 << 16;
+
+    FILE *file;
+    mutex fileMtx;
+    vector<string> buffers;
+};
+
+/// Finds the strongly connected components of the graph with an iterative version of Tarjan's algorithm.
+/// Fills componentOf with the component of each node and returns the number of components.
+/// Components are numbered in the order they are completed, so every edge between two different components
+/// goes from a higher to a lower component number, which is a reverse topological order of the condensed graph.
+template <typename GraphT>
+int computeScc(const GraphT &graph, vector<int> &componentOf) {
+    const int nodesCount = int(graph.size());
+    vector<int> index(nodesCount, -1);
+    vector<int> lowLink(nodesCount, 0);
+    vector<char> onStack(nodesCount, false);
+    vector<Node> sccStack;
+    vector<DfsFrame> callStack;
+    componentOf.assign(nodesCount, -1);
+    int nextIndex = 0;
+    int componentsCount = 0;
+    for (Node root = 0; root < nodesCount; root++) {
+        if (index[root] != -1) {
+            continue;
+        }
+        index[root] = lowLink[root] = nextIndex++;
+        sccStack.push_back(root);
+        onStack[root] = true;
+        callStack.push_back({ root, 0 });
+        while (!callStack.empty()) {
+            const Node curr = callStack.back().node;
+            const auto &neighs = graph[curr];
+            if (callStack.back().nextNeighIdx < int(neighs.size())) {
+                const Node neigh = neighs[callStack.back().nextNeighIdx++];
+                if (index[neigh] == -1) {
+                    // Unvisited neighbour, so go deeper into it
+                    index[neigh] = lowLink[neigh] = nextIndex++;
+                    sccStack.push_back(neigh);
+                    onStack[neigh] = true;
+                    callStack.push_back({ neigh, 0 });
+                }
+                else if (onStack[neigh]) {
+                    // Neighbour in the component that is still being built, so the current node belongs to it too
+                    lowLink[curr] = min(lowLink[curr], index[neigh]);
+                }
+                continue;
+            }
+            // All neighbours are done, so return to the parent with the lowest index reachable from here
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                const Node parent = callStack.back().node;
+                lowLink[parent] = min(lowLink[parent], lowLink[curr]);
+            }
+            // If nothing above the current node is reachable, it is the root of a component made of the nodes above it on the stack
+            if (lowLink[curr] == index[curr]) {
+                Node member;
+                do {
+                    member = sccStack.back();
+                    sccStack.pop_back();
+                    onStack[member] = false;
+                    componentOf[member] = componentsCount;
+                } while (member != curr);
+                componentsCount++;
+            }
+        }
+    }
+    return componentsCount;
+}
+
+// Number of random DFS traversals whose interval labels are kept for each component in the reachability index
+const int REACH_LABELS_COUNT = 4;
+
+/// Index for answering "can node A reach node B?" mostly without searching the graph.
+/// The graph is condensed to the DAG of its strongly connected components, and each component gets GRAIL-style labels
+/// from several random DFS traversals of the DAG. A label is the interval [low, rank] of post-order ranks of the component
+/// and everything below it, so a component can only reach components whose interval is nested in its own in every label.
+/// The first traversal also gives exact intervals of its DFS tree, which prove reachability when they are nested.
+/// Queries that neither check can decide fall back to a DFS on the DAG, pruned by the same labels.
+struct ReachabilityIndex {
+    vector<int> componentOf;
+    CsrGraph<Node> dag;
+    int labelsCount = 0;
+    // Labels of component c are at [c * labelsCount, (c + 1) * labelsCount)
+    vector<int> low;
+    vector<int> rank;
+    // Pre-order and post-order numbers of each component in the DFS tree of the first traversal
+    vector<int> treePre;
+    vector<int> treePost;
+
+    int componentsCount() const {
+        return dag.size();
+    }
+};
+
+/// Memory for reachability queries that is kept by the caller and reused across queries, one per thread.
+struct ReachWorkspace {
+    ReachWorkspace(const ReachabilityIndex &index)
+        : visited(index.componentsCount(), false)
+    {}
+
+    EpochArray<char> visited;
+    vector<Node> stack;
+    // Number of queries so far that had to search the DAG
+    long long fallbackSearches = 0;
+};
+
+// Labels the components with one random DFS traversal of the DAG, starting from its sources in random order
+// and visiting the children of each component in random order. Also fills the tree intervals if requested.
+void labelReachabilityTraversal(ReachabilityIndex &index, int labelIdx, mt19937 &rng, bool fillTree) {
+    const int componentsCount = index.componentsCount();
+    const int labelsCount = index.labelsCount;
+    // Shuffle the children of every component for this traversal
+    CsrGraph<Node> shuffled = index.dag;
+    for (Node comp = 0; comp < componentsCount; comp++) {
+        shuffle(shuffled.targets.begin() + shuffled.offsets[comp], shuffled.targets.begin() + shuffled.offsets[comp + 1], rng);
+    }
+    vector<int> inDegree(componentsCount, 0);
+    for (const Node target : shuffled.targets) {
+        inDegree[target]++;
+    }
+    vector<Node> roots;
+    for (Node comp = 0; comp < componentsCount; comp++) {
+        if (inDegree[comp] == 0) {
+            roots.push_back(comp);
+        }
+    }
+    shuffle(roots.begin(), roots.end(), rng);
+
+    vector<char> visited(componentsCount, false);
+    vector<DfsFrame> stack;
+    int nextRank = 1;
+    int nextPre = 0;
+    for (const Node root : roots) {
+        visited[root] = true;
+        stack.push_back({ root, 0 });
+        if (fillTree) {
+            index.treePre[root] = nextPre++;
+        }
+        while (!stack.empty()) {
+            const Node curr = stack.back().node;
+            const CsrRange<Node> children = shuffled[curr];
+            if (stack.back().nextNeighIdx < children.size()) {
+                const Node child = children[stack.back().nextNeighIdx++];
+                if (!visited[child]) {
+                    visited[child] = true;
+                    stack.push_back({ child, 0 });
+                    if (fillTree) {
+                        index.treePre[child] = nextPre++;
+                    }
+                }
+                continue;
+            }
+            // All children are labelled by now, since there are no cycles, so the lowest rank below includes all of them
+            stack.pop_back();
+            const int rank = nextRank++;
+            int low = rank;
+            for (const Node child : children) {
+                low = min(low, index.low[child * labelsCount + labelIdx]);
+            }
+            index.rank[curr * labelsCount + labelIdx] = rank;
+            index.low[curr * labelsCount + labelIdx] = low;
+            if (fillTree) {
+                index.treePost[curr] = rank;
+            }
+        }
+    }
+}
+
+/// Builds the reachability index of the graph with the given number of random labels per component.
+template <typename GraphT>
+ReachabilityIndex buildReachabilityIndex(const GraphT &graph, int labelsCount = REACH_LABELS_COUNT, unsigned seed = 1) {
+    ReachabilityIndex index;
+    const int componentsCount = computeScc(graph, index.componentOf);
+    // Condense the graph, keeping a single edge between each pair of connected components
+    vector< pair<Node, Node> > dagEdges;
+    for (Node node = 0; node < int(graph.size()); node++) {
+        for (const Node neigh : graph[node]) {
+            if (index.componentOf[node] != index.componentOf[neigh]) {
+                dagEdges.push_back({ index.componentOf[node], index.componentOf[neigh] });
+            }
+        }
+    }
+    sort(dagEdges.begin(), dagEdges.end());
+    dagEdges.erase(unique(dagEdges.begin(), dagEdges.end()), dagEdges.end());
+    index.dag = buildCsr(componentsCount, dagEdges);
+
+    index.labelsCount = labelsCount;
+    index.low.resize(size_t(componentsCount) * labelsCount);
+    index.rank.resize(size_t(componentsCount) * labelsCount);
+    index.treePre.resize(componentsCount);
+    index.treePost.resize(componentsCount);
+    mt19937 rng(seed);
+    for (int labelIdx = 0; labelIdx < labelsCount; labelIdx++) {
+        labelReachabilityTraversal(index, labelIdx, rng, labelIdx == 0);
+    }
+    return index;
+}
+
+// Returns false if the labels prove that the source component cannot reach the target component
+bool labelsMayReach(const ReachabilityIndex &index, Node sourceComp, Node targetComp) {
+    // Edges only go to lower component numbers
+    if (targetComp > sourceComp) {
+        return false;
+    }
+    const int *sourceLow = &index.low[sourceComp * index.labelsCount];
+    const int *sourceRank = &index.rank[sourceComp * index.labelsCount];
+    const int *targetLow = &index.low[targetComp * index.labelsCount];
+    const int *targetRank = &index.rank[targetComp * index.labelsCount];
+    for (int labelIdx = 0; labelIdx < index.labelsCount; labelIdx++) {
+        if (targetLow[labelIdx] < sourceLow[labelIdx] || targetRank[labelIdx] > sourceRank[labelIdx]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns true if the target component is in the DFS tree below the source component, which proves it is reachable
+bool treeReaches(const ReachabilityIndex &index, Node sourceComp, Node targetComp) {
+    return index.treePre[sourceComp] <= index.treePre[targetComp] && index.treePost[targetComp] <= index.treePost[sourceComp];
+}
+
+/// Returns true if the start node can reach the goal node, using the reachability index of the graph.
+bool canReach(const ReachabilityIndex &index, Node start, Node goal, ReachWorkspace &workspace) {
+    const Node startComp = index.componentOf[start];
+    const Node goalComp = index.componentOf[goal];
+    if (startComp == goalComp || treeReaches(index, startComp, goalComp)) {
+        return true;
+    }
+    if (!labelsMayReach(index, startComp, goalComp)) {
+        return false;
+    }
+    // Neither check could decide, so search the DAG, skipping every component the labels rule out
+    workspace.fallbackSearches++;
+    workspace.visited.reset();
+    workspace.stack.clear();
+    workspace.stack.push_back(startComp);
+    workspace.visited[startComp] = true;
+    while (!workspace.stack.empty()) {
+        const Node curr = workspace.stack.back();
+        workspace.stack.pop_back();
+        for (const Node child : index.dag[curr]) {
+            if (child == goalComp || treeReaches(index, child, goalComp)) {
+                return true;
+            }
+            if (!workspace.visited[child] && labelsMayReach(index, child, goalComp)) {
+                workspace.visited[child] = true;
+                workspace.stack.push_back(child);
+            }
+        }
+    }
+    return false;
+}
+
+/// Depth-first search a path from start node to goal node, first checking with the reachability index that there is one,
+/// so that queries without a path return immediately instead of exploring everything reachable from the start.
+/// The function returns true if a path is found, and fills the path vector with it.
+template <typename GraphT>
+bool dfs(const GraphT &graph, const ReachabilityIndex &index, int start, int goal, vector<int> &path,
+         DfsWorkspace &workspace, ReachWorkspace &reachWorkspace) {
+    if (!canReach(index, start, goal, reachWorkspace)) {
+        path.clear();
+        return false;
+    }
+    return dfs(graph, start, goal, path, workspace);
 }
 
 // Prints the given path to the console as a list of nodes, separated with commas.
@@ -46,7 +534,347 @@ void printPath(const vector<int> &path) {
     cout << "\n";
 }
 
-int main() {
+// Searches a path between the given nodes of a graph loaded from a binary graph file and prints it.
+// Returns the exit code for main().
+int searchInGraphFile(const char *filepath, Node start, Node goal) {
+    try {
+        Timer timer;
+        const GraphFile file(filepath);
+        const auto graph = file.graph();
+        cout << "Loaded " << graph.size() << " nodes and " << graph.edgesCount() << " edges in " << timer.elapsedMs() << " ms\n";
+        if (start < 0 || start >= graph.size() || goal < 0 || goal >= graph.size()) {
+            cout << "Invalid start or goal node\n";
+            return 1;
+        }
+        vector<Node> path;
+        timer.restart();
+        const bool found = dfs(graph, start, goal, path);
+        cout << "Searched in " << timer.elapsedMs() << " ms\n";
+        if (found) {
+            cout << "Path found: ";
+            printPath(path);
+        }
+        else {
+            cout << "No path :(\n";
+        }
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Longest path the benchmark searches with the recursive DFS, deeper ones risk overflowing the default 1 MB stack on Windows
+const int BENCH_MAX_RECURSION_DEPTH = 10000;
+
+// Compares the recursive and the iterative DFS on chains of growing length, on a star and on a random graph,
+// and checks that both find the same paths wherever the recursive one can run
+void benchIterative(int nodesCount, int avgDegree) {
+    cout << "DFS from the start to the end of a chain\n";
+    for (int length = 1000; length <= nodesCount; length *= 10) {
+        Graph chain(length);
+        for (Node node = 0; node + 1 < length; node++) {
+            chain[node].push_back(node + 1);
+        }
+        const CsrGraph<Node> graph = buildCsr(chain);
+        vector<Node> recursivePath;
+        vector<Node> path;
+        cout << "  length " << length << ": recursive ";
+        if (length <= BENCH_MAX_RECURSION_DEPTH) {
+            vector<bool> visited(graph.size(), false);
+            Timer timer;
+            dfsCore(graph, visited, 0, length - 1, recursivePath);
+            cout << timer.elapsedMs() << " ms";
+        }
+        else {
+            cout << "skipped, too deep for the thread stack";
+        }
+        Timer timer;
+        dfsIterative(graph, 0, length - 1, path);
+        cout << ", iterative " << timer.elapsedMs() << " ms";
+        if (length <= BENCH_MAX_RECURSION_DEPTH) {
+            cout << ", " << ((path == recursivePath) ? "same paths" : "DIFFERENT paths");
+        }
+        cout << "\n";
+    }
+
+    // Every step of the iterative search goes back to the center, so this shows the cost of getting its neighbours each time.
+    // The star is stored as nested vectors, the other graph type that the searches take.
+    const int starLeavesCount = min(nodesCount, 50000);
+    cout << "DFS on a star with " << starLeavesCount << " leaves stored as nested vectors\n";
+    Graph star(starLeavesCount + 1);
+    for (Node leaf = 1; leaf <= starLeavesCount; leaf++) {
+        star[0].push_back(leaf);
+    }
+    {
+        vector<Node> recursivePath;
+        vector<Node> path;
+        vector<bool> visited(star.size(), false);
+        Timer timer;
+        dfsCore(star, visited, 0, starLeavesCount, recursivePath);
+        cout << "  recursive: " << timer.elapsedMs() << " ms";
+        timer.restart();
+        dfsIterative(star, 0, starLeavesCount, path);
+        cout << ", iterative: " << timer.elapsedMs() << " ms, " << ((path == recursivePath) ? "same paths" : "DIFFERENT paths") << "\n";
+    }
+
+    cout << "DFS on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const CsrGraph<Node> graph = buildCsr(nodesCount, generateRandomEdges(nodesCount, nodesCount * avgDegree));
+    const int queriesCount = 100;
+    const vector<Node> starts = generateRandomNodes(nodesCount, queriesCount, 2);
+    const vector<Node> goals = generateRandomNodes(nodesCount, queriesCount, 3);
+    // The paths on random graphs are long, so the recursive search can only be run if the graph is small
+    const bool runRecursive = (nodesCount <= BENCH_MAX_RECURSION_DEPTH);
+    DfsWorkspace workspace(graph.size());
+    vector< vector<Node> > recursivePaths(queriesCount);
+    long long pathsLength = 0;
+    Timer timer;
+    if (runRecursive) {
+        for (int query = 0; query < queriesCount; query++) {
+            workspace.visited.reset();
+            dfsCore(graph, workspace.visited, starts[query], goals[query], recursivePaths[query]);
+            pathsLength += recursivePaths[query].size();
+        }
+        cout << "  recursive: " << timer.elapsedMs() / queriesCount << " ms/query, average path length " << pathsLength / queriesCount << "\n";
+    }
+    vector<Node> path;
+    bool samePaths = true;
+    pathsLength = 0;
+    timer.restart();
+    for (int query = 0; query < queriesCount; query++) {
+        dfs(graph, starts[query], goals[query], path, workspace);
+        pathsLength += path.size();
+        samePaths = samePaths && (path == recursivePaths[query]);
+    }
+    cout << "  iterative: " << timer.elapsedMs() / queriesCount << " ms/query, average path length " << pathsLength / queriesCount;
+    if (runRecursive) {
+        cout << ", " << (samePaths ? "same paths" : "DIFFERENT paths");
+    }
+    cout << "\n";
+}
+
+// Measures the rate of enumerating all simple paths up to the given length between random nodes, with 1 to maxThreads threads
+void benchPaths(int nodesCount, int avgDegree, int maxThreads, int maxLength) {
+    cout << "Simple paths of at most " << maxLength << " edges on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const CsrGraph<Node> graph = buildCsr(nodesCount, generateRandomEdges(nodesCount, nodesCount * avgDegree));
+    const vector<Node> ends = generateRandomNodes(nodesCount, 2);
+    const PathCallback ignorePath = [](int, const vector<Node>&) {};
+    double singleThreadMs = 0.0;
+    for (int threadsCount = 1; threadsCount <= maxThreads; threadsCount++) {
+        Timer timer;
+        const long long pathsCount = enumerateSimplePaths(graph, ends[0], ends[1], maxLength, threadsCount, ignorePath);
+        const double timeMs = timer.elapsedMs();
+        if (threadsCount == 1) {
+            singleThreadMs = timeMs;
+        }
+        cout << "  " << threadsCount << " threads: " << pathsCount << " paths in " << timeMs << " ms, "
+             << double(pathsCount) / (timeMs / 1000.0) << " paths/s, speedup " << singleThreadMs / timeMs << "\n";
+    }
+}
+
+// Compares answering reachability queries with a DFS and with the reachability index on a random graph with mostly forward edges,
+// which has many strongly connected components and a DAG that is far from trivial
+void benchReach(int nodesCount, int avgDegree) {
+    cout << "Reachability on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << ", mostly forward edges\n";
+    vector< pair<Node, Node> > edges = generateRandomEdges(nodesCount, nodesCount * avgDegree);
+    for (int idx = 0; idx < int(edges.size()); idx++) {
+        // Keep one edge in a hundred as it is, turn the rest from the lower to the higher node
+        if (idx % 100 != 0 && edges[idx].first > edges[idx].second) {
+            swap(edges[idx].first, edges[idx].second);
+        }
+    }
+    const CsrGraph<Node> graph = buildCsr(nodesCount, edges);
+
+    Timer timer;
+    const ReachabilityIndex index = buildReachabilityIndex(graph);
+    const double buildMs = timer.elapsedMs();
+    const size_t indexBytes = sizeof(int) * (index.componentOf.size() + index.dag.offsets.size() + index.dag.targets.size()
+                                             + index.low.size() + index.rank.size() + index.treePre.size() + index.treePost.size());
+    cout << "  index: " << index.componentsCount() << " components, " << index.dag.edgesCount() << " DAG edges, "
+         << indexBytes / (1024 * 1024) << " MB, built in " << buildMs << " ms\n";
+
+    const int queriesCount = 1000;
+    const vector<Node> starts = generateRandomNodes(nodesCount, queriesCount, 2);
+    const vector<Node> goals = generateRandomNodes(nodesCount, queriesCount, 3);
+    DfsWorkspace workspace(graph.size());
+    vector<Node> path;
+    int reachableCount = 0;
+    timer.restart();
+    for (int query = 0; query < queriesCount; query++) {
+        reachableCount += dfs(graph, starts[query], goals[query], path, workspace);
+    }
+    cout << "  DFS: " << timer.elapsedMs() * 1000.0 / queriesCount << " us/query, " << reachableCount << " reachable\n";
+
+    ReachWorkspace reachWorkspace(index);
+    reachableCount = 0;
+    timer.restart();
+    for (int query = 0; query < queriesCount; query++) {
+        reachableCount += canReach(index, starts[query], goals[query], reachWorkspace);
+    }
+    cout << "  index: " << timer.elapsedMs() * 1000.0 / queriesCount << " us/query, " << reachableCount << " reachable, "
+         << reachWorkspace.fallbackSearches << " needed a search\n";
+}
+
+// Compares the recursive DFS on a random graph stored as a CSR graph and as a compressed graph.
+// The paths on random graphs are long, so the graph is never larger than the recursion allows.
+void benchCompressed(int nodesCount, int avgDegree) {
+    nodesCount = min(nodesCount, BENCH_MAX_RECURSION_DEPTH);
+    cout << "DFS on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const CsrGraph<Node> graph = buildCsr(nodesCount, generateRandomEdges(nodesCount, nodesCount * avgDegree));
+    const CompressedGraph compressed = compressGraph(graph);
+    cout << "  CSR: " << double(sizeof(int) * (graph.offsets.size() + graph.targets.size())) / graph.edgesCount()
+         << " bytes/edge, compressed: " << double(compressed.sizeInBytes()) / graph.edgesCount() << " bytes/edge\n";
+
+    const int queriesCount = 1000;
+    const vector<Node> starts = generateRandomNodes(nodesCount, queriesCount, 2);
+    const vector<Node> goals = generateRandomNodes(nodesCount, queriesCount, 3);
+    DfsWorkspace workspace(nodesCount);
+    vector<Node> path;
+    double timesMs[2];
+    int foundCounts[2] = { 0, 0 };
+    for (int graphIdx = 0; graphIdx < 2; graphIdx++) {
+        Timer timer;
+        for (int query = 0; query < queriesCount; query++) {
+            workspace.visited.reset();
+            path.clear();
+            foundCounts[graphIdx] += (graphIdx == 0) ? dfsCore(graph, workspace.visited, starts[query], goals[query], path)
+                                                     : dfsCore(compressed, workspace.visited, starts[query], goals[query], path);
+        }
+        timesMs[graphIdx] = timer.elapsedMs();
+    }
+    cout << "  CSR: " << timesMs[0] * 1000.0 / queriesCount << " us/query, " << foundCounts[0] << " found\n";
+    cout << "  compressed: " << timesMs[1] * 1000.0 / queriesCount << " us/query, " << foundCounts[1] << " found, slowdown "
+         << timesMs[1] / timesMs[0] << "\n";
+}
+
+// Runs the benchmark with the given name, with optional size parameters from the command line.
+// Returns false if there is no such benchmark.
+bool runBenchmark(const char *name, int argc, char **argv) {
+    const int nodesCount = (argc > 0) ? atoi(argv[0]) : 1000000;
+    const int avgDegree = (argc > 1) ? atoi(argv[1]) : 8;
+    if (strcmp(name, "iterative") == 0) {
+        benchIterative(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "compressed") == 0) {
+        benchCompressed(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "reach") == 0) {
+        benchReach(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "paths") == 0) {
+        const int maxThreads = (argc > 2) ? atoi(argv[2]) : max(int(thread::hardware_concurrency()), 1);
+        const int maxLength = (argc > 3) ? atoi(argv[3]) : 8;
+        benchPaths(nodesCount, avgDegree, maxThreads, maxLength);
+        return true;
+    }
+    cout << "Unknown benchmark " << name << "\n";
+    return false;
+}
+
+// Writes all simple paths up to the given length between the given nodes of a graph file to a text file.
+// Returns the exit code for main().
+int writePathsFromGraphFile(const char *graphPath, Node start, Node goal, int maxLength, const char *outputPath, int threadsCount) {
+    // The writer keeps a buffer per thread of the enumeration, so both must agree on the number of threads
+    if (threadsCount < 1) {
+        cout << "Invalid number of threads\n";
+        return 1;
+    }
+    try {
+        const GraphFile file(graphPath);
+        const CsrView graph = file.graph();
+        if (start < 0 || start >= graph.size() || goal < 0 || goal >= graph.size()) {
+            cout << "Invalid start or goal node\n";
+            return 1;
+        }
+        PathFileWriter writer(outputPath, threadsCount);
+        Timer timer;
+        const long long pathsCount = enumerateSimplePaths(graph, start, goal, maxLength, threadsCount, [&](int threadIdx, const vector<Node> &path) {
+            writer.write(threadIdx, path);
+        });
+        const double timeMs = timer.elapsedMs();
+        cout << "Found " << pathsCount << " paths in " << timeMs << " ms, " << double(pathsCount) / (timeMs / 1000.0) << " paths/s\n";
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Serves queries on a graph loaded from a binary graph file, from stdin or from clients of a Unix socket if its path is given.
+// "dfs <start> <goal>" is answered with the length of a path and its nodes, or -1, and "reach <start> <goal>" with 1 or 0,
+// both with the help of a reachability index built once at startup.
+// Returns the exit code for main().
+int serveGraphFile(const char *filepath, int threadsCount, const char *socketPath) {
+    try {
+        Timer timer;
+        const GraphFile file(filepath);
+        const CsrView graph = file.graph();
+        const ReachabilityIndex index = buildReachabilityIndex(graph);
+        ThreadPool pool(threadsCount);
+        // Every thread of the pool searches with its own workspaces and path
+        vector<DfsWorkspace> workspaces(pool.size(), DfsWorkspace(graph.size()));
+        vector<ReachWorkspace> reachWorkspaces(pool.size(), ReachWorkspace(index));
+        vector< vector<Node> > paths(pool.size());
+        const QueryAnswerer answer = [&](int threadIdx, const char *line, string &result) {
+            NodeQuery query;
+            if (!parseNodeQuery(line, graph.size(), query)) {
+                result += "error invalid query";
+                return;
+            }
+            if (strcmp(query.kind, "dfs") == 0) {
+                vector<Node> &path = paths[threadIdx];
+                const bool found = dfs(graph, index, query.start, query.goal, path, workspaces[threadIdx], reachWorkspaces[threadIdx]);
+                appendPathAnswer(result, found, int(path.size()) - 1, path);
+            }
+            else if (strcmp(query.kind, "reach") == 0) {
+                result += canReach(index, query.start, query.goal, reachWorkspaces[threadIdx]) ? '1' : '0';
+            }
+            else {
+                result += "error unknown query";
+            }
+        };
+        // The answers go to stdout, so everything else goes to stderr
+        cerr << "Loaded " << graph.size() << " nodes and " << graph.edgesCount() << " edges and built the reachability index in "
+             << timer.elapsedMs() << " ms, serving with " << pool.size() << " threads\n";
+        if (socketPath != nullptr) {
+            serveUnixSocket(socketPath, pool, answer);
+        }
+        else {
+            serveQueries(0, 1, pool, answer);
+        }
+    }
+    catch (const exception &e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    // Run a benchmark instead of the example if requested with "bench <name> [nodes] [degree] [threads] [length]"
+    if (argc > 2 && strcmp(argv[1], "bench") == 0) {
+        return runBenchmark(argv[2], argc - 3, argv + 3) ? 0 : 1;
+    }
+    // Write all simple paths to a file if requested with "paths <graph.bin> <start> <goal> <length> <output.txt> [threads]"
+    if (argc > 6 && strcmp(argv[1], "paths") == 0) {
+        const int threadsCount = (argc > 7) ? atoi(argv[7]) : max(int(thread::hardware_concurrency()), 1);
+        return writePathsFromGraphFile(argv[2], atoi(argv[3]), atoi(argv[4]), atoi(argv[5]), argv[6], threadsCount);
+    }
+    // Serve queries on a graph file if requested with "serve <graph.bin> [threads] [socket path]"
+    if (argc > 2 && strcmp(argv[1], "serve") == 0) {
+        const int threadsCount = (argc > 3) ? atoi(argv[3]) : max(int(thread::hardware_concurrency()), 1);
+        return serveGraphFile(argv[2], threadsCount, (argc > 4) ? argv[4] : nullptr);
+    }
+    // Search in a graph file instead of the example graph if requested with "<graph.bin> <start> <goal>"
+    if (argc == 4) {
+        return searchInGraphFile(argv[1], atoi(argv[2]), atoi(argv[3]));
+    }
+
     // Create graph
     const Graph graph {
         { 1 },
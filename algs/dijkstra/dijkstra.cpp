@@ -2,6 +2,21 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <random>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include "../common/csr_graph.h"
+#include "../common/bench.h"
+#include "../common/epoch_array.h"
+#include "../common/graph_file.h"
+#include "../common/graph_reorder.h"
+#include "../common/indexed_heap.h"
+#include "../common/bucket_queues.h"
+#include "../common/thread_pool.h"
+#include "../common/query_server.h"
 using namespace std;
 
 const int DIST_INF = 2147483647;
@@ -21,72 +36,2430 @@ struct Edge {
 
 typedef vector< vector<Edge> > Graph;
 
-bool dijkstraCore(const Graph &graph, vector<bool> &visited, Node start, Node goal, vector<Edge> &parent) {
-    // Setup a priorty queue of visited nodes (edges) waiting to have their neighbours searched. Begin with the start node only.
-    priority_queue<Edge> prQu;
-    prQu.push({start, 0});
+// Returns the node the edge points to, needed by the generic CSR graph functions like buildReverseCsr()
+Node targetNode(const Edge &edge) {
+    return edge.node;
+}
+
+// Returns the edge with the same weight pointing to the given node, needed by the generic CSR graph functions
+Edge retarget(const Edge &edge, Node node) {
+    return { node, edge.weight };
+}
+
+// Fills the path vector with the path from start node to goal node, by following the parents in the given parent array.
+template <typename ParentArray>
+void tracePath(const ParentArray &parent, Node start, Node goal, vector<Node> &path) {
+    path.clear();
+    // Start with the goal state and go back the path
+    Node curr = goal;
+    // until we reach the start state
+    while (curr != start) {
+        // by following the parent of each next node
+        path.push_back(curr);
+        curr = parent[curr].node;
+    }
+    // In the end we have to add the start node and reverse the path so that it begins with the start and ends at the goal
+    path.push_back(start);
+    reverse(path.begin(), path.end());
+}
+
+// Priority queue used by dijkstraCore() unless another queue policy is given
+typedef IndexedDaryHeap<4> DijkstraHeap;
+
+/// The graph can be either a Graph or a CsrGraph<Edge>, both provide size() and operator[] for the edges of a node.
+/// The visited and parent arrays can be either vectors or the EpochArrays of a DijkstraWorkspace.
+/// The queue must be empty and is left empty. Its type is the queue policy, see IndexedDaryHeap for what it must provide.
+/// Every settled node is given to isDone(node), and the search stops as soon as it returns true.
+template <typename GraphT, typename VisitedArray, typename ParentArray, typename Queue, typename IsDone>
+void dijkstraCoreUntil(const GraphT &graph, VisitedArray &visited, Node start, ParentArray &parent, Queue &queue, IsDone isDone) {
+    // Setup a priority queue of nodes waiting to have their neighbours searched, keyed by their tentative distance.
+    // Begin with the start node only.
+    queue.pushOrDecrease(start, 0);
     // Pop nodes from the queue until it's empty
-    while (!prQu.empty()) {
-        const Edge curr = prQu.top();
-        prQu.pop();
+    while (!queue.empty()) {
+        // The popped node has the smallest tentative distance, so that distance is final
+        const Node curr = queue.popMin();
+        visited[curr] = true;
+        // If it is the last node we are looking for, then we are done
+        if (isDone(curr)) {
+            queue.clear();
+            break;
+        }
+        const int currDist = parent[curr].weight;
         // Traverse the neighbours of each popped node
-        for (const Edge &neigh : graph[curr.node]) {
+        for (const Edge &neigh : graph[curr]) {
             // Skip it if it's already visited
             if (visited[neigh.node]) {
                 continue;
             }
             // Calculate the distance to the neighbour through this edge
-            int neighDist = parent[curr.node].weight + neigh.weight;
+            const int neighDist = currDist + neigh.weight;
             // If the new distance is smaller than the currently best distance
             if (neighDist < parent[neigh.node].weight) {
-                // Update the parent and the distance of the neighbour
-                parent[neigh.node] = { curr.node, neighDist };
-                prQu.push(neigh);
+                // Update the parent and the distance of the neighbour, and its position in the queue
+                parent[neigh.node] = { curr, neighDist };
+                queue.pushOrDecrease(neigh.node, neighDist);
             }
         }
-        visited[curr.node] = true;
     }
-    return parent[goal].node > -1;
+}
+
+/// Search with Dijkstra algorithm from the start node, see dijkstraCoreUntil() for the arrays and the queue.
+/// The search stops as soon as the goal is settled. A goal of -1 is never settled, so the whole reachable graph is searched.
+template <typename GraphT, typename VisitedArray, typename ParentArray, typename Queue>
+bool dijkstraCore(const GraphT &graph, VisitedArray &visited, Node start, Node goal, ParentArray &parent, Queue &queue) {
+    dijkstraCoreUntil(graph, visited, start, parent, queue, [goal](Node curr) { return curr == goal; });
+    return goal >= 0 && parent[goal].node > -1;
+}
+
+/// Same as the dijkstraCore() above, with a new queue of the given queue policy.
+template <typename Queue = DijkstraHeap, typename GraphT, typename VisitedArray, typename ParentArray>
+bool dijkstraCore(const GraphT &graph, VisitedArray &visited, Node start, Node goal, ParentArray &parent) {
+    Queue queue(graph.size());
+    return dijkstraCore(graph, visited, start, goal, parent, queue);
 }
 
 /// Search with Dijkstra algorithm the shortest path from start node to goal node of the given graph.
 /// The function returns true if a path is found, and fills the path vector with it.
-bool dijkstra(const Graph &graph, Node start, Node goal, vector<Node> &path) {
+/// The queue policy is chosen at compile time, e.g. dijkstra<RadixHeap>(...) for integer weights.
+template <typename Queue = DijkstraHeap, typename GraphT>
+bool dijkstra(const GraphT &graph, Node start, Node goal, vector<Node> &path) {
     // Setup parents array that keeps track of the parent of each node, -1 for no parent.
     vector<Edge> parent(graph.size(), { -1, DIST_INF });
     parent[start] = { -2, 0 };
     vector<bool> visited(graph.size(), false);
     // Perform the actual BFS to search for a path and fill the parent array
-    if (dijkstraCore(graph, visited, start, goal, parent)) {
-        path.clear();
-        // Start with the goal state and go back the path
-        Node curr = goal;
-        // until we reach the start state
-        while (curr != start) {
-            // by following the parent of each next node
+    if (dijkstraCore<Queue>(graph, visited, start, goal, parent)) {
+        tracePath(parent, start, goal, path);
+        return true;
+    }
+    return false;
+}
+
+/// Memory for Dijkstra queries that is kept by the caller and reused across queries on graphs with the same number of nodes.
+/// Resetting it is O(1), so a query that touches only a few nodes of a huge graph costs only as much as those nodes.
+struct DijkstraWorkspace {
+    DijkstraWorkspace(int nodesCount)
+        : parent(nodesCount, { -1, DIST_INF })
+        , visited(nodesCount, false)
+        , queue(nodesCount)
+    {}
+
+    EpochArray<Edge> parent;
+    EpochArray<char> visited;
+    DijkstraHeap queue;
+};
+
+/// Search with Dijkstra algorithm the shortest path from start node to goal node of the given graph, reusing the given workspace.
+/// The function returns true if a path is found, and fills the path vector with it.
+template <typename GraphT>
+bool dijkstra(const GraphT &graph, Node start, Node goal, vector<Node> &path, DijkstraWorkspace &workspace) {
+    workspace.parent.reset();
+    workspace.visited.reset();
+    workspace.parent[start] = { -2, 0 };
+    if (dijkstraCore(graph, workspace.visited, start, goal, workspace.parent, workspace.queue)) {
+        tracePath(workspace.parent, start, goal, path);
+        return true;
+    }
+    return false;
+}
+
+/// Memory for distance table queries that is kept by the caller and reused across searches on graphs with the same number of nodes.
+/// A many-to-many query needs one per thread.
+struct DistanceTableWorkspace {
+    DistanceTableWorkspace(int nodesCount)
+        : search(nodesCount)
+        , isTarget(nodesCount, false)
+    {}
+
+    DijkstraWorkspace search;
+    EpochArray<char> isTarget;
+};
+
+/// One-to-many query, writes the distances from the source to each of the targets into dists, DIST_INF for the unreachable ones.
+/// It is a single Dijkstra search that stops as soon as all targets are settled, instead of one search per target.
+/// The targets may repeat, and dists must have room for as many values as there are targets.
+template <typename GraphT>
+void dijkstraOneToMany(const GraphT &graph, Node source, const vector<Node> &targets, int *dists, DistanceTableWorkspace &ws) {
+    ws.isTarget.reset();
+    int targetsLeft = 0;
+    for (const Node target : targets) {
+        if (!ws.isTarget[target]) {
+            ws.isTarget[target] = true;
+            targetsLeft++;
+        }
+    }
+    // Without targets the search would never stop early and would settle the whole graph for nothing
+    if (targetsLeft == 0) {
+        return;
+    }
+    ws.search.parent.reset();
+    ws.search.visited.reset();
+    ws.search.parent[source] = { -2, 0 };
+    dijkstraCoreUntil(graph, ws.search.visited, source, ws.search.parent, ws.search.queue, [&](Node curr) {
+        return ws.isTarget[curr] && --targetsLeft == 0;
+    });
+    // All targets are settled unless the search ran out of nodes, and then the ones not reached are still at DIST_INF
+    for (int targetIdx = 0; targetIdx < int(targets.size()); targetIdx++) {
+        dists[targetIdx] = ws.search.parent[targets[targetIdx]].weight;
+    }
+}
+
+/// Same as the dijkstraOneToMany() above, returning the distances in a new vector.
+template <typename GraphT>
+vector<int> dijkstraOneToMany(const GraphT &graph, Node source, const vector<Node> &targets) {
+    DistanceTableWorkspace ws(graph.size());
+    vector<int> dists(targets.size());
+    dijkstraOneToMany(graph, source, targets, dists.data(), ws);
+    return dists;
+}
+
+/// Many-to-many query, fills the table with the distances from each source to each target, DIST_INF for the unreachable ones.
+/// The table is a contiguous row-major matrix, with the distance from sources[i] to targets[j] at i * targets.size() + j.
+/// It runs one one-to-many search per source in parallel on the pool, each thread with its own workspace,
+/// and writes straight into the row of its source. The workspaces are kept by the caller, one per thread of the pool.
+template <typename GraphT>
+void dijkstraManyToMany(const GraphT &graph, const vector<Node> &sources, const vector<Node> &targets, vector<int> &table,
+                        ThreadPool &pool, vector<DistanceTableWorkspace> &workspaces) {
+    if (int(workspaces.size()) < pool.size()) {
+        throw runtime_error("Not enough workspaces for the threads of the pool.");
+    }
+    const size_t rowSize = targets.size();
+    table.resize(sources.size() * rowSize);
+    pool.parallelFor(int(sources.size()), 1, [&](int threadIdx, int begin, int end) {
+        for (int sourceIdx = begin; sourceIdx < end; sourceIdx++) {
+            dijkstraOneToMany(graph, sources[sourceIdx], targets, table.data() + sourceIdx * rowSize, workspaces[threadIdx]);
+        }
+    });
+}
+
+/// Same as the dijkstraManyToMany() above, with new workspaces for the threads of the pool.
+template <typename GraphT>
+void dijkstraManyToMany(const GraphT &graph, const vector<Node> &sources, const vector<Node> &targets, vector<int> &table, ThreadPool &pool) {
+    vector<DistanceTableWorkspace> workspaces(pool.size(), DistanceTableWorkspace(graph.size()));
+    dijkstraManyToMany(graph, sources, targets, table, pool, workspaces);
+}
+
+/// Topological order of the nodes of a graph, if it is a directed acyclic graph.
+/// Every edge goes from a node to a later one in the order, and position has the index of each node in it.
+struct DagOrder {
+    bool isDag = false;
+    vector<Node> order;
+    vector<int> position;
+};
+
+/// Checks whether the graph is acyclic with Kahn's algorithm, in O(V + E), and finds its topological order if it is.
+/// Nodes with no incoming edges left are taken one by one, and if some nodes never get there, they are on a cycle.
+/// It is done once for a graph, and then dijkstra() with the result uses it for all searches on that graph.
+template <typename GraphT>
+DagOrder computeDagOrder(const GraphT &graph) {
+    const int nodesCount = int(graph.size());
+    vector<int> inDegree(nodesCount, 0);
+    for (Node node = 0; node < nodesCount; node++) {
+        for (const Edge &neigh : graph[node]) {
+            inDegree[neigh.node]++;
+        }
+    }
+    DagOrder dag;
+    dag.order.reserve(nodesCount);
+    for (Node node = 0; node < nodesCount; node++) {
+        if (inDegree[node] == 0) {
+            dag.order.push_back(node);
+        }
+    }
+    // The order itself serves as the queue of nodes whose incoming edges are all done
+    for (int orderIdx = 0; orderIdx < int(dag.order.size()); orderIdx++) {
+        for (const Edge &neigh : graph[dag.order[orderIdx]]) {
+            if (--inDegree[neigh.node] == 0) {
+                dag.order.push_back(neigh.node);
+            }
+        }
+    }
+    dag.isDag = (int(dag.order.size()) == nodesCount);
+    if (!dag.isDag) {
+        dag.order.clear();
+        return dag;
+    }
+    dag.position.resize(nodesCount);
+    for (int orderIdx = 0; orderIdx < nodesCount; orderIdx++) {
+        dag.position[dag.order[orderIdx]] = orderIdx;
+    }
+    return dag;
+}
+
+/// Shortest paths in a directed acyclic graph by relaxing the edges of each node once, in topological order, with no queue at all.
+/// All edges into a node come from earlier nodes, so its distance is final when its turn comes, and nodes before the start are skipped.
+/// The parent array is setup and filled like for dijkstraCore(). The search stops at the goal, and a goal of -1 searches the whole graph.
+template <typename GraphT, typename ParentArray>
+bool dagShortestPaths(const GraphT &graph, const DagOrder &dag, Node start, Node goal, ParentArray &parent) {
+    const int endIdx = (goal >= 0) ? dag.position[goal] : int(graph.size());
+    for (int orderIdx = dag.position[start]; orderIdx < endIdx; orderIdx++) {
+        const Node curr = dag.order[orderIdx];
+        const int currDist = parent[curr].weight;
+        // Nodes not reachable from the start have nothing to relax
+        if (currDist == DIST_INF) {
+            continue;
+        }
+        for (const Edge &neigh : graph[curr]) {
+            const int neighDist = currDist + neigh.weight;
+            if (neighDist < parent[neigh.node].weight) {
+                parent[neigh.node] = { curr, neighDist };
+            }
+        }
+    }
+    return goal >= 0 && parent[goal].node > -1;
+}
+
+/// Search the shortest path from start node to goal node of the given graph, with the order found by computeDagOrder() for it.
+/// If the graph is a DAG, the path is found with dagShortestPaths() in linear time, and otherwise with Dijkstra.
+/// The function returns true if a path is found, and fills the path vector with it.
+template <typename Queue = DijkstraHeap, typename GraphT>
+bool dijkstra(const GraphT &graph, Node start, Node goal, vector<Node> &path, const DagOrder &dag) {
+    if (!dag.isDag) {
+        return dijkstra<Queue>(graph, start, goal, path);
+    }
+    vector<Edge> parent(graph.size(), { -1, DIST_INF });
+    parent[start] = { -2, 0 };
+    if (dagShortestPaths(graph, dag, start, goal, parent)) {
+        tracePath(parent, start, goal, path);
+        return true;
+    }
+    return false;
+}
+
+// Settles the next node of one side of a bidirectional Dijkstra and relaxes its edges.
+// The side's own visited and parent arrays are extended, and each relaxed edge is checked against the other side's
+// distances for a shorter connection between the two sides, which is stored in bestDist and meetNode.
+// Returns the distance of the settled node from the root of its side.
+template <typename GraphT, typename VisitedArray, typename ParentArray, typename Queue>
+int settleBidirectionalNode(const GraphT &graph, Queue &queue, VisitedArray &visited, ParentArray &parent,
+                            const ParentArray &otherParent, int &bestDist, Node &meetNode) {
+    const Node curr = queue.popMin();
+    visited[curr] = true;
+    const int currDist = parent[curr].weight;
+    for (const Edge &neigh : graph[curr]) {
+        if (visited[neigh.node]) {
+            continue;
+        }
+        const int neighDist = currDist + neigh.weight;
+        if (neighDist < parent[neigh.node].weight) {
+            parent[neigh.node] = { curr, neighDist };
+            queue.pushOrDecrease(neigh.node, neighDist);
+        }
+        // If the other side has reached the neighbour too, this edge connects the two sides
+        const int otherDist = otherParent[neigh.node].weight;
+        if (otherDist != DIST_INF && neighDist + otherDist < bestDist) {
+            bestDist = neighDist + otherDist;
+            meetNode = neigh.node;
+        }
+    }
+    return currDist;
+}
+
+/// Bidirectional Dijkstra, searching forward from the start node on the graph and backward from the goal node on the reverse graph.
+/// The two sides take turns, always settling a node of the side with the smaller radius so far,
+/// and the shortest connection between them seen so far is kept as the best distance.
+/// The search stops when the smallest keys in the two queues add up to at least the best distance, as no path can be shorter then.
+/// The key just popped is the smallest of its queue, and the last key popped on the other side is a lower bound of the smallest there.
+/// The forward parent array and visited array are setup like for dijkstraCore(). The backward parent array has { -1, DIST_INF }
+/// for all nodes except { -2, 0 } for the goal, and gets filled with the next node on the way to the goal and the distance to it.
+/// The node where the shortest path goes from the forward to the backward side is stored in meetNode.
+template <typename Queue = DijkstraHeap, typename GraphT, typename VisitedArray, typename ParentArray>
+bool dijkstraCoreBidirectional(const GraphT &graph, const GraphT &reverseGraph, Node start, Node goal,
+                               VisitedArray &forwardVisited, VisitedArray &backwardVisited,
+                               ParentArray &forwardParent, ParentArray &backwardParent, Node &meetNode) {
+    if (start == goal) {
+        meetNode = start;
+        return true;
+    }
+    Queue forwardQueue(graph.size());
+    Queue backwardQueue(graph.size());
+    forwardQueue.pushOrDecrease(start, 0);
+    backwardQueue.pushOrDecrease(goal, 0);
+    int bestDist = DIST_INF;
+    meetNode = -1;
+    int forwardRadius = 0;
+    int backwardRadius = 0;
+    while (!forwardQueue.empty() && !backwardQueue.empty()) {
+        if (forwardRadius <= backwardRadius) {
+            forwardRadius = settleBidirectionalNode(graph, forwardQueue, forwardVisited, forwardParent, backwardParent,
+                                                    bestDist, meetNode);
+        }
+        else {
+            backwardRadius = settleBidirectionalNode(reverseGraph, backwardQueue, backwardVisited, backwardParent, forwardParent,
+                                                     bestDist, meetNode);
+        }
+        // Compare in long long, as the best distance can still be DIST_INF
+        if ((long long)forwardRadius + backwardRadius >= bestDist) {
+            break;
+        }
+    }
+    return meetNode != -1;
+}
+
+/// Search with a bidirectional Dijkstra the shortest path from start node to goal node of the given graph.
+/// The reverse graph must be built from the graph with buildReverseCsr(), once for all searches on the graph.
+/// The function returns true if a path is found, and fills the path vector with it.
+template <typename Queue = DijkstraHeap, typename GraphT>
+bool dijkstraBidirectional(const GraphT &graph, const GraphT &reverseGraph, Node start, Node goal, vector<Node> &path) {
+    vector<Edge> forwardParent(graph.size(), { -1, DIST_INF });
+    vector<Edge> backwardParent(graph.size(), { -1, DIST_INF });
+    forwardParent[start] = { -2, 0 };
+    backwardParent[goal] = { -2, 0 };
+    vector<bool> forwardVisited(graph.size(), false);
+    vector<bool> backwardVisited(graph.size(), false);
+    Node meetNode;
+    if (dijkstraCoreBidirectional<Queue>(graph, reverseGraph, start, goal, forwardVisited, backwardVisited,
+                                         forwardParent, backwardParent, meetNode)) {
+        // The first half of the path goes from the start to the meeting node
+        tracePath(forwardParent, start, meetNode, path);
+        // and the second half follows the backward parents from the meeting node to the goal
+        for (Node curr = backwardParent[meetNode].node; curr >= 0; curr = backwardParent[curr].node) {
             path.push_back(curr);
-            curr = parent[curr].node;
         }
-        // In the end we have to add the start node and reverse the path so that it begins with the start and ends at the goal
-        path.push_back(start);
-        reverse(path.begin(), path.end());
         return true;
     }
     return false;
 }
 
-// Prints the given path to the console as a list of nodes, separated with commas.
-void printPath(const vector<Node> &path) {
-    for (int i = 0; i < path.size(); i++) {
-        cout << path[i];
-        if (i < path.size() - 1) {
-            cout << ", ";
+/// Returns the distances of a full Dijkstra search from the given start node, DIST_INF for the nodes it cannot reach.
+template <typename Queue = DijkstraHeap, typename GraphT>
+vector<int> fullDijkstraDists(const GraphT &graph, Node start) {
+    vector<Edge> parent(graph.size(), { -1, DIST_INF });
+    vector<bool> visited(graph.size(), false);
+    parent[start] = { -2, 0 };
+    dijkstraCore<Queue>(graph, visited, start, -1, parent);
+    vector<int> dists(graph.size());
+    for (Node node = 0; node < int(graph.size()); node++) {
+        dists[node] = parent[node].weight;
+    }
+    return dists;
+}
+
+// Potential of the nodes from which the goal is known to be unreachable. It must be larger than any real distance.
+const int ALT_UNREACHABLE_POTENTIAL = DIST_INF / 4;
+
+/// Distances between a few landmark nodes and all nodes of a graph, for the lower bounds of ALT searches.
+/// The distances of each node are stored together, first the ones from each landmark to the node
+/// and then the ones from the node to each landmark, so a bound for a node reads a single block of memory.
+/// The view does not own its memory, which is either kept by a Landmarks or mapped from a file by a LandmarkFile.
+struct LandmarkView {
+    int nodesCount = 0;
+    int landmarksCount = 0;
+    const Node *landmarks = nullptr;
+    const int *dists = nullptr;
+
+    const int* distsFrom(Node node) const {
+        return dists + size_t(node) * 2 * landmarksCount;
+    }
+
+    const int* distsTo(Node node) const {
+        return distsFrom(node) + landmarksCount;
+    }
+};
+
+/// Landmark distances kept in memory, as built by buildLandmarks().
+struct Landmarks {
+    int nodesCount = 0;
+    vector<Node> nodes;
+    vector<int> dists;
+
+    LandmarkView view() const {
+        return { nodesCount, int(nodes.size()), nodes.data(), dists.data() };
+    }
+};
+
+/// Returns a lower bound of the distance from one node to another, by the triangle inequality with each landmark.
+/// Distances to unreachable nodes are DIST_INF in the landmark table, and bounds cannot be taken from those.
+/// If a landmark shows that the second node is unreachable from the first one, ALT_UNREACHABLE_POTENTIAL is returned.
+inline int landmarkLowerBound(const LandmarkView &landmarks, Node from, Node to) {
+    const int *fromDistsFrom = landmarks.distsFrom(from);
+    const int *fromDistsTo = landmarks.distsTo(from);
+    const int *toDistsFrom = landmarks.distsFrom(to);
+    const int *toDistsTo = landmarks.distsTo(to);
+    int bound = 0;
+    for (int idx = 0; idx < landmarks.landmarksCount; idx++) {
+        // d(L, to) <= d(L, from) + d(from, to)
+        if (fromDistsFrom[idx] != DIST_INF) {
+            if (toDistsFrom[idx] == DIST_INF) {
+                return ALT_UNREACHABLE_POTENTIAL;
+            }
+            bound = max(bound, toDistsFrom[idx] - fromDistsFrom[idx]);
+        }
+        // d(from, L) <= d(from, to) + d(to, L)
+        if (toDistsTo[idx] != DIST_INF) {
+            if (fromDistsTo[idx] == DIST_INF) {
+                return ALT_UNREACHABLE_POTENTIAL;
+            }
+            bound = max(bound, fromDistsTo[idx] - toDistsTo[idx]);
         }
     }
-    cout << "\n";
+    return bound;
+}
+
+/// Ways of choosing the landmarks. Landmarks far away from each other, around the edges of the graph, give the best bounds.
+enum LandmarkSelection {
+    // Each landmark is the node farthest from the landmarks chosen before
+    LANDMARKS_FARTHEST,
+    // The avoid method by Goldberg and Werneck, where each landmark is the leaf of the shortest path tree of a random node
+    // in the subtree whose distances are the worst covered by the landmarks chosen before
+    LANDMARKS_AVOID
+};
+
+// Returns the node farthest from the landmarks chosen so far, among the nodes reachable from them, or -1 if there is none.
+// The covered distance of each node is the distance to it from its closest landmark, and is updated by the caller.
+Node selectFarthestLandmark(const vector<int> &coveredDist) {
+    Node farthest = -1;
+    for (Node node = 0; node < int(coveredDist.size()); node++) {
+        if (coveredDist[node] != DIST_INF && (farthest == -1 || coveredDist[node] > coveredDist[farthest])) {
+            farthest = node;
+        }
+    }
+    return (farthest != -1 && coveredDist[farthest] > 0) ? farthest : -1;
+}
+
+// Returns the next landmark by the avoid method, starting from the given root node, or -1 if it leads only to chosen landmarks.
+// The weight of a node is how much the lower bound from the root to it falls short of the real distance.
+// The size of a node is the total weight of its subtree in the shortest path tree of the root, or 0 if the subtree has a landmark.
+// The landmark is the leaf reached by going down from the root to the child of the largest size each time.
+template <typename GraphT>
+Node selectAvoidLandmark(const GraphT &graph, const LandmarkView &landmarks, const vector<bool> &isLandmark, Node root) {
+    const int nodesCount = int(graph.size());
+    vector<Edge> parent(nodesCount, { -1, DIST_INF });
+    vector<bool> visited(nodesCount, false);
+    parent[root] = { -2, 0 };
+    dijkstraCore(graph, visited, root, -1, parent);
+    vector< pair<Node, Node> > treeEdges;
+    for (Node node = 0; node < nodesCount; node++) {
+        if (parent[node].node >= 0) {
+            treeEdges.push_back({ parent[node].node, node });
+        }
+    }
+    const CsrGraph<Node> children = buildCsr(nodesCount, treeEdges);
+
+    // Parents come before their children in preorder, so going through it backwards adds up the subtrees bottom-up
+    vector<Node> preorder = { root };
+    for (int idx = 0; idx < int(preorder.size()); idx++) {
+        for (const Node child : children[preorder[idx]]) {
+            preorder.push_back(child);
+        }
+    }
+    vector<long long> subtreeSize(nodesCount, 0);
+    vector<bool> hasLandmark(isLandmark);
+    for (int idx = int(preorder.size()) - 1; idx >= 0; idx--) {
+        const Node node = preorder[idx];
+        subtreeSize[node] += parent[node].weight - landmarkLowerBound(landmarks, root, node);
+        if (hasLandmark[node]) {
+            subtreeSize[node] = 0;
+        }
+        if (node != root) {
+            subtreeSize[parent[node].node] += subtreeSize[node];
+            hasLandmark[parent[node].node] = hasLandmark[parent[node].node] || hasLandmark[node];
+        }
+    }
+    Node curr = root;
+    while (true) {
+        Node bestChild = -1;
+        for (const Node child : children[curr]) {
+            if (subtreeSize[child] > 0 && (bestChild == -1 || subtreeSize[child] > subtreeSize[bestChild])) {
+                bestChild = child;
+            }
+        }
+        if (bestChild == -1) {
+            break;
+        }
+        curr = bestChild;
+    }
+    return isLandmark[curr] ? -1 : curr;
+}
+
+/// Chooses the given number of landmarks with the given selection method and computes the distances between them and all nodes.
+/// The reverse graph must be built from the graph with buildReverseCsr(). Choosing needs a few full Dijkstra searches per landmark.
+template <typename GraphT>
+Landmarks buildLandmarks(const GraphT &graph, const GraphT &reverseGraph, int landmarksCount, LandmarkSelection selection,
+                         unsigned seed = 1) {
+    const int nodesCount = int(graph.size());
+    landmarksCount = min(landmarksCount, nodesCount);
+    Landmarks landmarks;
+    landmarks.nodesCount = nodesCount;
+    landmarks.nodes.reserve(landmarksCount);
+    landmarks.dists.assign(size_t(nodesCount) * 2 * landmarksCount, DIST_INF);
+    // The view already has the final layout, and the landmarks not chosen yet have only DIST_INF, which gives no bounds
+    LandmarkView view = { nodesCount, landmarksCount, landmarks.nodes.data(), landmarks.dists.data() };
+    vector<bool> isLandmark(nodesCount, false);
+    mt19937 rng(seed);
+    uniform_int_distribution<int> nodeDist(0, nodesCount - 1);
+
+    // The first farthest landmark is the node farthest from a random node
+    vector<int> coveredDist;
+    if (selection == LANDMARKS_FARTHEST && landmarksCount > 0) {
+        coveredDist = fullDijkstraDists(graph, nodeDist(rng));
+    }
+    for (int idx = 0; idx < landmarksCount; idx++) {
+        Node landmark = -1;
+        if (selection == LANDMARKS_FARTHEST) {
+            landmark = selectFarthestLandmark(coveredDist);
+        }
+        else {
+            for (int attempt = 0; attempt < 10 && landmark == -1; attempt++) {
+                landmark = selectAvoidLandmark(graph, view, isLandmark, nodeDist(rng));
+            }
+        }
+        // Fall back to a random node when the selection finds only chosen landmarks
+        while (landmark == -1 || isLandmark[landmark]) {
+            landmark = nodeDist(rng);
+        }
+        isLandmark[landmark] = true;
+        landmarks.nodes.push_back(landmark);
+
+        const vector<int> fromDists = fullDijkstraDists(graph, landmark);
+        const vector<int> toDists = fullDijkstraDists(reverseGraph, landmark);
+        for (Node node = 0; node < nodesCount; node++) {
+            landmarks.dists[size_t(node) * 2 * landmarksCount + idx] = fromDists[node];
+            landmarks.dists[size_t(node) * 2 * landmarksCount + landmarksCount + idx] = toDists[node];
+            if (selection == LANDMARKS_FARTHEST) {
+                coveredDist[node] = min(coveredDist[node], fromDists[node]);
+            }
+        }
+    }
+    return landmarks;
+}
+
+/// Binary landmark file layout, all values are 32-bit integers in the native byte order:
+///   header            LandmarkFileHeader
+///   landmarks         landmarksCount values, the landmark nodes
+///   dists             nodesCount * 2 * landmarksCount values, laid out like in LandmarkView
+struct LandmarkFileHeader {
+    char magic[4];
+    int version;
+    int nodesCount;
+    int landmarksCount;
+};
+
+const char LANDMARK_FILE_MAGIC[4] = { 'F', 'M', 'I', 'L' };
+const int LANDMARK_FILE_VERSION = 1;
+
+/// Writes the landmark distances to a file, which can then be mapped with LandmarkFile.
+void writeLandmarkFile(const char *filepath, const LandmarkView &landmarks) {
+    FILE *file = fopen(filepath, "wb");
+    if (file == nullptr) {
+        throw runtime_error("Cannot open landmark file for writing.");
+    }
+    LandmarkFileHeader header;
+    memcpy(header.magic, LANDMARK_FILE_MAGIC, sizeof(LANDMARK_FILE_MAGIC));
+    header.version = LANDMARK_FILE_VERSION;
+    header.nodesCount = landmarks.nodesCount;
+    header.landmarksCount = landmarks.landmarksCount;
+    const size_t distsCount = size_t(landmarks.nodesCount) * 2 * landmarks.landmarksCount;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    written = written && fwrite(landmarks.landmarks, sizeof(Node), landmarks.landmarksCount, file) == size_t(landmarks.landmarksCount);
+    written = written && fwrite(landmarks.dists, sizeof(int), distsCount, file) == distsCount;
+    if (fclose(file) != 0 || !written) {
+        throw runtime_error("Cannot write landmark file.");
+    }
+}
+
+/// Landmark file mapped into memory. The view points directly into the mapping, so it is valid while the LandmarkFile lives.
+struct LandmarkFile {
+    LandmarkFile(const char *filepath)
+        : file(filepath)
+    {
+        LandmarkFileHeader header;
+        if (file.getSize() < sizeof(LandmarkFileHeader)) {
+            throw runtime_error("Landmark file is too small.");
+        }
+        memcpy(&header, file.getData(), sizeof(LandmarkFileHeader));
+        if (memcmp(header.magic, LANDMARK_FILE_MAGIC, sizeof(LANDMARK_FILE_MAGIC)) != 0 || header.version != LANDMARK_FILE_VERSION) {
+            throw runtime_error("Invalid landmark file header.");
+        }
+        const size_t valuesCount = size_t(header.landmarksCount) + size_t(header.nodesCount) * 2 * header.landmarksCount;
+        if (file.getSize() < sizeof(LandmarkFileHeader) + valuesCount * sizeof(int)) {
+            throw runtime_error("Landmark file is truncated.");
+        }
+        landmarks.nodesCount = header.nodesCount;
+        landmarks.landmarksCount = header.landmarksCount;
+        landmarks.landmarks = reinterpret_cast<const Node*>(file.getData() + sizeof(LandmarkFileHeader));
+        landmarks.dists = landmarks.landmarks + header.landmarksCount;
+    }
+
+    LandmarkView view() const {
+        return landmarks;
+    }
+
+private:
+    MappedFile file;
+    LandmarkView landmarks;
+};
+
+/// Potential of the nodes for an A* search towards the given goal, the landmark lower bound of their distance to it.
+struct LandmarkPotential {
+    LandmarkView landmarks;
+    Node goal;
+
+    int operator()(Node node) const {
+        return landmarkLowerBound(landmarks, node, goal);
+    }
+};
+
+/// Graph adapter that gives every edge (u, v) the reduced cost weight + potential(v) - potential(u).
+/// Dijkstra on the reduced costs settles the nodes in the same order as A* with the potential as its heuristic,
+/// so dijkstraCore() runs A* on it unchanged. The potential must be consistent, which keeps all reduced costs non-negative.
+/// The potential of each node is computed once and cached. The reduced distance of a node v from the start s is
+/// its real distance + potential(v) - potential(s).
+template <typename GraphT, typename Potential>
+struct ReducedCostGraph {
+    typedef decltype(declval<const GraphT&>()[0].begin()) BaseIterator;
+
+    struct Iterator {
+        BaseIterator base;
+        const ReducedCostGraph *graph;
+        int fromPotential;
+
+        Edge operator*() const {
+            const Edge edge = *base;
+            return { edge.node, edge.weight + graph->potentialOf(edge.node) - fromPotential };
+        }
+
+        Iterator& operator++() {
+            ++base;
+            return *this;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return base != other.base;
+        }
+    };
+
+    struct Range {
+        Iterator first;
+        Iterator last;
+
+        Iterator begin() const {
+            return first;
+        }
+
+        Iterator end() const {
+            return last;
+        }
+    };
+
+    ReducedCostGraph(const GraphT &graph, const Potential &potential)
+        : graph(graph)
+        , potential(potential)
+        , potentialCache(graph.size(), -1)
+    {}
+
+    int size() const {
+        return int(graph.size());
+    }
+
+    Range operator[](Node node) const {
+        auto &&edges = graph[node];
+        const int nodePotential = potentialOf(node);
+        return { { edges.begin(), this, nodePotential }, { edges.end(), this, nodePotential } };
+    }
+
+    int potentialOf(Node node) const {
+        if (potentialCache[node] == -1) {
+            potentialCache[node] = potential(node);
+        }
+        return potentialCache[node];
+    }
+
+private:
+    const GraphT &graph;
+    Potential potential;
+    mutable vector<int> potentialCache;
+};
+
+/// A* search with the landmark lower bounds as heuristic (ALT), done by dijkstraCore() on the reduced costs of the graph.
+/// The visited and parent arrays are setup like for dijkstraCore(). The parent array gets the reduced distances,
+/// which for the goal is its real distance minus the lower bound from the start to the goal.
+template <typename Queue = DijkstraHeap, typename GraphT, typename VisitedArray, typename ParentArray>
+bool dijkstraCoreAlt(const GraphT &graph, const LandmarkView &landmarks, VisitedArray &visited, Node start, Node goal, ParentArray &parent) {
+    const ReducedCostGraph<GraphT, LandmarkPotential> reducedGraph(graph, { landmarks, goal });
+    return dijkstraCore<Queue>(reducedGraph, visited, start, goal, parent);
+}
+
+/// Search with A* and landmark lower bounds the shortest path from start node to goal node of the given graph.
+/// The landmarks must be built for this graph with buildLandmarks(), once for all searches on the graph.
+/// The function returns true if a path is found, and fills the path vector with it.
+template <typename Queue = DijkstraHeap, typename GraphT>
+bool dijkstraAlt(const GraphT &graph, const LandmarkView &landmarks, Node start, Node goal, vector<Node> &path) {
+    vector<Edge> parent(graph.size(), { -1, DIST_INF });
+    parent[start] = { -2, 0 };
+    vector<bool> visited(graph.size(), false);
+    if (dijkstraCoreAlt<Queue>(graph, landmarks, visited, start, goal, parent)) {
+        tracePath(parent, start, goal, path);
+        return true;
+    }
+    return false;
+}
+
+// Number of nodes per chunk handed to a thread in the parallel steps of delta-stepping
+const int DELTA_STEPPING_CHUNK_SIZE = 256;
+
+// Packs a distance and a parent node into one 64-bit value, with the distance in the high bits,
+// so that both can be updated together with a single atomic operation
+inline uint64_t packDistParent(int dist, Node parent) {
+    return (uint64_t(unsigned(dist)) << 32) | unsigned(parent);
+}
+
+// Lowers the distance of the node to the given one with the given parent, if it is strictly shorter.
+// An equal distance keeps the old parent, as a parent swapped on a tie over a zero-weight edge can close a cycle of parents,
+// and the start, marked with parent -2, is never changed. Returns true if it was lowered. Safe to call from many threads at once.
+inline bool atomicRelax(atomic<uint64_t> &distParent, int dist, Node parent) {
+    const uint64_t newValue = packDistParent(dist, parent);
+    uint64_t oldValue = distParent.load(memory_order_relaxed);
+    while (dist < int(oldValue >> 32) && Node(unsigned(oldValue)) != -2) {
+        if (distParent.compare_exchange_weak(oldValue, newValue, memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Relaxes in parallel the light or the heavy edges of the given nodes, those with weight up to delta or above it.
+// Each thread collects the nodes whose distance it lowered into its own list.
+template <typename GraphT>
+void relaxDeltaSteppingEdges(const GraphT &graph, const vector<Node> &nodes, int delta, bool light,
+                             vector< atomic<uint64_t> > &distParent, vector< vector<Node> > &requests, ThreadPool &pool) {
+    pool.parallelFor(int(nodes.size()), DELTA_STEPPING_CHUNK_SIZE, [&](int threadIdx, int begin, int end) {
+        for (int idx = begin; idx < end; idx++) {
+            const Node curr = nodes[idx];
+            const int currDist = int(distParent[curr].load(memory_order_relaxed) >> 32);
+            for (const Edge &neigh : graph[curr]) {
+                if ((neigh.weight <= delta) == light && atomicRelax(distParent[neigh.node], currDist + neigh.weight, curr)) {
+                    requests[threadIdx].push_back(neigh.node);
+                }
+            }
+        }
+    });
+}
+
+/// Parallel single-source shortest paths with delta-stepping by Meyer and Sanders, on the threads of the given pool.
+/// Nodes are kept in buckets of width delta by their tentative distance, and all nodes of the lowest bucket are processed
+/// in parallel. Their light edges, with weight up to delta, can put nodes back into the same bucket, so those are relaxed
+/// repeatedly until the bucket stays empty, and the heavy edges only once at the end, as they always lead to later buckets.
+/// A small delta gets close to Dijkstra with little parallelism, and a large one to Bellman-Ford with much wasted work.
+/// Fills the parent array like a full dijkstraCore() search with goal -1: the parent and the distance of every node,
+/// { -2, 0 } for the start and { -1, DIST_INF } for the nodes it cannot reach. Delta must be at least 1.
+template <typename GraphT>
+void deltaStepping(const GraphT &graph, Node start, int delta, vector<Edge> &parent, ThreadPool &pool) {
+    if (delta < 1) {
+        throw runtime_error("Delta-stepping needs a bucket width of at least 1.");
+    }
+    const int nodesCount = int(graph.size());
+    vector< atomic<uint64_t> > distParent(nodesCount);
+    pool.parallelFor(nodesCount, 4096, [&](int, int begin, int end) {
+        for (Node node = begin; node < end; node++) {
+            distParent[node].store(packDistParent(DIST_INF, -1), memory_order_relaxed);
+        }
+    });
+    distParent[start].store(packDistParent(0, -2));
+
+    // The tentative distances of all nodes in buckets are at most the largest edge weight past the current bucket,
+    // so a circular array of buckets that covers that range holds them all, whatever the largest distance is
+    int maxWeight = 0;
+    for (Node node = 0; node < nodesCount; node++) {
+        for (const Edge &neigh : graph[node]) {
+            maxWeight = max(maxWeight, neigh.weight);
+        }
+    }
+    const int bucketsCount = (maxWeight + delta - 1) / delta + 1;
+    // Buckets may have stale entries of nodes whose distance was lowered after, and those are skipped when the bucket is processed
+    vector< vector<Node> > buckets(bucketsCount);
+    buckets[0].push_back(start);
+    long long entriesCount = 1;
+    vector< vector<Node> > requests(pool.size());
+    vector<Node> frontier;
+    vector<Node> bucketNodes;
+    // Phase of the last time each node was put in the frontier and bucket it was last added to the bucket nodes in, to skip duplicates
+    vector<int> frontierPhase(nodesCount, -1);
+    vector<int> settledBucket(nodesCount, -1);
+    int phase = 0;
+    const auto distOf = [&](Node node) { return int(distParent[node].load(memory_order_relaxed) >> 32); };
+    const auto addRequests = [&]() {
+        for (vector<Node> &threadRequests : requests) {
+            for (const Node node : threadRequests) {
+                buckets[(distOf(node) / delta) % bucketsCount].push_back(node);
+            }
+            entriesCount += threadRequests.size();
+            threadRequests.clear();
+        }
+    };
+    for (int bucketIdx = 0; entriesCount > 0; bucketIdx++) {
+        vector<Node> &bucket = buckets[bucketIdx % bucketsCount];
+        bucketNodes.clear();
+        while (!bucket.empty()) {
+            phase++;
+            frontier.clear();
+            for (const Node node : bucket) {
+                if (distOf(node) / delta == bucketIdx && frontierPhase[node] != phase) {
+                    frontierPhase[node] = phase;
+                    frontier.push_back(node);
+                    if (settledBucket[node] != bucketIdx) {
+                        settledBucket[node] = bucketIdx;
+                        bucketNodes.push_back(node);
+                    }
+                }
+            }
+            entriesCount -= bucket.size();
+            bucket.clear();
+            relaxDeltaSteppingEdges(graph, frontier, delta, true, distParent, requests, pool);
+            addRequests();
+        }
+        // The distances in this bucket are final now, so the heavy edges are relaxed only once
+        relaxDeltaSteppingEdges(graph, bucketNodes, delta, false, distParent, requests, pool);
+        addRequests();
+    }
+
+    parent.resize(nodesCount);
+    pool.parallelFor(nodesCount, 4096, [&](int, int begin, int end) {
+        for (Node node = begin; node < end; node++) {
+            const uint64_t value = distParent[node].load(memory_order_relaxed);
+            parent[node] = { int(unsigned(value)), int(value >> 32) };
+        }
+    });
 }
 
-int main() {
+/// Weighted graph whose edges can be inserted, removed and reweighted. Every node keeps its outgoing edges and its incoming ones,
+/// stored as the source node and the weight, so that both directions can be followed from a changed edge.
+/// It provides size() and operator[] for the outgoing edges of a node like a Graph, so dijkstraCore() runs on it directly.
+/// Changing an edge does not update the shortest paths kept for it, which have to be told with DynamicShortestPaths::edgeChanged().
+struct DynamicGraph {
+    DynamicGraph(int nodesCount)
+        : outEdges(nodesCount)
+        , inEdges(nodesCount)
+    {}
+
+    DynamicGraph(int nodesCount, const vector< pair<Node, Edge> > &edges)
+        : DynamicGraph(nodesCount)
+    {
+        for (const pair<Node, Edge> &edge : edges) {
+            insertEdge(edge.first, edge.second.node, edge.second.weight);
+        }
+    }
+
+    int size() const {
+        return int(outEdges.size());
+    }
+
+    const vector<Edge>& operator[](Node node) const {
+        return outEdges[node];
+    }
+
+    /// Returns the incoming edges of the node, each with the node it comes from
+    const vector<Edge>& inNeighbours(Node node) const {
+        return inEdges[node];
+    }
+
+    /// Returns the weight of the edge between the nodes, or DIST_INF if there is no such edge
+    int edgeWeight(Node from, Node to) const {
+        const int idx = findEdge(outEdges[from], to);
+        return (idx == -1) ? DIST_INF : outEdges[from][idx].weight;
+    }
+
+    void insertEdge(Node from, Node to, int weight) {
+        outEdges[from].push_back({ to, weight });
+        inEdges[to].push_back({ from, weight });
+    }
+
+    /// Changes the weight of an edge between the nodes and returns its old weight.
+    /// If there are several edges between them, only the first one is changed.
+    int reweightEdge(Node from, Node to, int weight) {
+        const int outIdx = findEdge(outEdges[from], to);
+        if (outIdx == -1) {
+            throw runtime_error("Reweighting an edge that does not exist.");
+        }
+        const int oldWeight = outEdges[from][outIdx].weight;
+        outEdges[from][outIdx].weight = weight;
+        inEdges[to][findEdge(inEdges[to], from, oldWeight)].weight = weight;
+        return oldWeight;
+    }
+
+    /// Removes an edge between the nodes and returns its weight. If there are several edges between them, only the first one is removed.
+    int removeEdge(Node from, Node to) {
+        const int outIdx = findEdge(outEdges[from], to);
+        if (outIdx == -1) {
+            throw runtime_error("Removing an edge that does not exist.");
+        }
+        const int weight = outEdges[from][outIdx].weight;
+        // The order of the edges of a node does not matter, so the last one takes the place of the removed one
+        outEdges[from][outIdx] = outEdges[from].back();
+        outEdges[from].pop_back();
+        vector<Edge> &toInEdges = inEdges[to];
+        toInEdges[findEdge(toInEdges, from, weight)] = toInEdges.back();
+        toInEdges.pop_back();
+        return weight;
+    }
+
+private:
+    // Returns the index of the first edge to the given node in the list, with the given weight unless it is -1, or -1 if there is none
+    static int findEdge(const vector<Edge> &edges, Node node, int weight = -1) {
+        for (int idx = 0; idx < int(edges.size()); idx++) {
+            if (edges[idx].node == node && (weight == -1 || edges[idx].weight == weight)) {
+                return idx;
+            }
+        }
+        return -1;
+    }
+
+    vector< vector<Edge> > outEdges;
+    vector< vector<Edge> > inEdges;
+};
+
+/// Shortest paths from a single source in a DynamicGraph, repaired after each edge change instead of searched again,
+/// in the style of Ramalingam and Reps. The parent array is the same as after a full dijkstraCore() search with goal -1.
+/// A shorter or new edge can only make the paths through its target shorter, so a Dijkstra search starts from the target
+/// and goes only as far as the distances improve. A longer or removed edge matters only if it is the parent edge of its target,
+/// and then only the nodes under it in the tree of parents can get longer paths. These affected nodes are cut off,
+/// each gets the best distance through its incoming edges from the rest of the tree, and a Dijkstra search among them
+/// finds the final ones. Either way only the nodes around the change are searched.
+struct DynamicShortestPaths {
+    DynamicShortestPaths(const DynamicGraph &graph, Node source)
+        : source(source)
+        , parent(graph.size(), { -1, DIST_INF })
+        , affected(graph.size(), false)
+        , queue(graph.size())
+    {
+        vector<bool> visited(graph.size(), false);
+        parent[source] = { -2, 0 };
+        dijkstraCore(graph, visited, source, -1, parent, queue);
+    }
+
+    /// Repairs the shortest paths after the edge between the nodes changed its weight from oldWeight to newWeight in the graph,
+    /// where DIST_INF stands for no edge, so an inserted edge has an old weight of DIST_INF and a removed one a new weight of DIST_INF.
+    /// The graph must already have the change. Returns the number of nodes whose shortest path was searched again.
+    int edgeChanged(const DynamicGraph &graph, Node from, Node to, int oldWeight, int newWeight) {
+        if (newWeight < oldWeight) {
+            return repairShorterEdge(graph, from, to, newWeight);
+        }
+        // A longer edge that is not on the path to its target changes nothing
+        if (newWeight > oldWeight && parent[to].node == from && parent[from].weight != DIST_INF
+            && parent[from].weight + oldWeight == parent[to].weight) {
+            return repairLongerEdge(graph, to);
+        }
+        return 0;
+    }
+
+    Node source;
+    vector<Edge> parent;
+
+private:
+    int repairShorterEdge(const DynamicGraph &graph, Node from, Node to, int weight) {
+        if (parent[from].weight == DIST_INF || parent[from].weight + weight >= parent[to].weight) {
+            return 0;
+        }
+        parent[to] = { from, parent[from].weight + weight };
+        queue.pushOrDecrease(to, parent[to].weight);
+        int searchedCount = 0;
+        while (!queue.empty()) {
+            const Node curr = queue.popMin();
+            searchedCount++;
+            const int currDist = parent[curr].weight;
+            for (const Edge &neigh : graph[curr]) {
+                if (currDist + neigh.weight < parent[neigh.node].weight) {
+                    parent[neigh.node] = { curr, currDist + neigh.weight };
+                    queue.pushOrDecrease(neigh.node, currDist + neigh.weight);
+                }
+            }
+        }
+        return searchedCount;
+    }
+
+    int repairLongerEdge(const DynamicGraph &graph, Node root) {
+        // The affected nodes are the root and everything under it in the tree of parents,
+        // found by following the edges of each affected node to the nodes it is the parent of
+        affected.reset();
+        vector<Node> affectedNodes = { root };
+        affected[root] = true;
+        for (int idx = 0; idx < int(affectedNodes.size()); idx++) {
+            const Node curr = affectedNodes[idx];
+            for (const Edge &neigh : graph[curr]) {
+                if (parent[neigh.node].node == curr && !affected[neigh.node]) {
+                    affected[neigh.node] = true;
+                    affectedNodes.push_back(neigh.node);
+                }
+            }
+        }
+        for (const Node node : affectedNodes) {
+            parent[node] = { -1, DIST_INF };
+        }
+        // The distances of all other nodes stay the same, so each affected node starts with its best edge from one of them
+        for (const Node node : affectedNodes) {
+            for (const Edge &inEdge : graph.inNeighbours(node)) {
+                const int inDist = parent[inEdge.node].weight;
+                if (!affected[inEdge.node] && inDist != DIST_INF && inDist + inEdge.weight < parent[node].weight) {
+                    parent[node] = { inEdge.node, inDist + inEdge.weight };
+                }
+            }
+            if (parent[node].weight != DIST_INF) {
+                queue.pushOrDecrease(node, parent[node].weight);
+            }
+        }
+        // and a Dijkstra search among the affected nodes lowers them to their shortest paths through each other
+        while (!queue.empty()) {
+            const Node curr = queue.popMin();
+            const int currDist = parent[curr].weight;
+            for (const Edge &neigh : graph[curr]) {
+                if (affected[neigh.node] && currDist + neigh.weight < parent[neigh.node].weight) {
+                    parent[neigh.node] = { curr, currDist + neigh.weight };
+                    queue.pushOrDecrease(neigh.node, currDist + neigh.weight);
+                }
+            }
+        }
+        return int(affectedNodes.size());
+    }
+
+    EpochArray<char> affected;
+    DijkstraHeap queue;
+};
+
+// Maximum number of nodes a witness search settles before giving up, in which case the shortcut is added just in case
+const int CH_WITNESS_SETTLE_LIMIT = 500;
+
+/// Edge of a contraction hierarchy. A shortcut stands for the two edges through its middle node, -1 for an original edge.
+struct ChEdge {
+    Node node;
+    int weight;
+    Node middle;
+};
+
+/// Contraction hierarchy of a graph, for fast point-to-point shortest path queries.
+/// The nodes are ranked by the order they were contracted in, and every edge connects a lower ranked node to a higher ranked one.
+/// The upward graph has the edges (u, x) going up from u, and the reverse upward graph has the edges (x, u) coming down to u,
+/// stored at u and pointing to x. A query only searches upward in both, from the start and from the goal.
+struct ContractionHierarchy {
+    vector<int> rank;
+    CsrGraph<ChEdge> upward;
+    CsrGraph<ChEdge> reverseUpward;
+    int shortcutsCount = 0;
+
+    int size() const {
+        return int(rank.size());
+    }
+};
+
+// Adds the edge to the list, or shortens the edge to the same node if the list already has a longer one
+void addOrShortenChEdge(vector<ChEdge> &edges, const ChEdge &newEdge) {
+    for (ChEdge &edge : edges) {
+        if (edge.node == newEdge.node) {
+            if (newEdge.weight < edge.weight) {
+                edge = newEdge;
+            }
+            return;
+        }
+    }
+    edges.push_back(newEdge);
+}
+
+// The remaining graph during contraction, with the edges in both directions of every node that is not contracted yet
+struct ChRemainingGraph {
+    vector< vector<ChEdge> > outEdges;
+    vector< vector<ChEdge> > inEdges;
+    vector<char> removed;
+};
+
+// Memory of one thread for witness searches
+struct WitnessWorkspace {
+    WitnessWorkspace(int nodesCount)
+        : dist(nodesCount, DIST_INF)
+        , isTarget(nodesCount, false)
+        , queue(nodesCount)
+    {}
+
+    EpochArray<int> dist;
+    EpochArray<char> isTarget;
+    DijkstraHeap queue;
+};
+
+// Runs a Dijkstra from the source on the remaining graph without the skipped node, and fills the distances in the workspace.
+// It stops when all targets marked in the workspace are settled, at nodes farther than maxDist,
+// or after CH_WITNESS_SETTLE_LIMIT settled nodes, so the distances of the nodes not settled may be too long.
+void runWitnessSearch(const ChRemainingGraph &graph, Node source, Node skipped, int maxDist, int targetsCount, WitnessWorkspace &ws) {
+    ws.dist.reset();
+    ws.dist[source] = 0;
+    ws.queue.pushOrDecrease(source, 0);
+    int settledCount = 0;
+    while (!ws.queue.empty()) {
+        const Node curr = ws.queue.popMin();
+        const int currDist = ws.dist[curr];
+        if (++settledCount > CH_WITNESS_SETTLE_LIMIT) {
+            ws.queue.clear();
+            break;
+        }
+        if (ws.isTarget[curr] && --targetsCount == 0) {
+            ws.queue.clear();
+            break;
+        }
+        for (const ChEdge &edge : graph.outEdges[curr]) {
+            if (edge.node == skipped || graph.removed[edge.node]) {
+                continue;
+            }
+            // Nodes farther than the longest path through the contracted node cannot be on a witness
+            const int neighDist = currDist + edge.weight;
+            if (neighDist <= maxDist && neighDist < ws.dist[edge.node]) {
+                ws.dist[edge.node] = neighDist;
+                ws.queue.pushOrDecrease(edge.node, neighDist);
+            }
+        }
+    }
+}
+
+// Finds the shortcuts needed to contract the node: for each pair of an in-neighbour u and an out-neighbour x,
+// the path u -> node -> x needs a shortcut unless a witness search from u finds another path to x that is not longer.
+// Adds the shortcuts to the given list if it is not null, and returns their number.
+int findShortcuts(const ChRemainingGraph &graph, Node node, WitnessWorkspace &ws, vector< pair<Node, ChEdge> > *shortcuts) {
+    int shortcutsCount = 0;
+    ws.isTarget.reset();
+    int maxOutWeight = 0;
+    for (const ChEdge &outEdge : graph.outEdges[node]) {
+        ws.isTarget[outEdge.node] = true;
+        maxOutWeight = max(maxOutWeight, outEdge.weight);
+    }
+    for (const ChEdge &inEdge : graph.inEdges[node]) {
+        // The in-neighbour is a target itself if it is an out-neighbour too, and it is settled first
+        const int targetsCount = int(graph.outEdges[node].size());
+        runWitnessSearch(graph, inEdge.node, node, inEdge.weight + maxOutWeight, targetsCount, ws);
+        for (const ChEdge &outEdge : graph.outEdges[node]) {
+            const int viaDist = inEdge.weight + outEdge.weight;
+            if (outEdge.node != inEdge.node && ws.dist[outEdge.node] > viaDist) {
+                shortcutsCount++;
+                if (shortcuts != nullptr) {
+                    shortcuts->push_back({ inEdge.node, { outEdge.node, viaDist, node } });
+                }
+            }
+        }
+    }
+    return shortcutsCount;
+}
+
+// Returns the contraction priority of the node, lower is contracted earlier. It is mainly the edge difference, the number of shortcuts
+// minus the number of edges removed by contracting the node. The number of its neighbours already contracted and its depth,
+// one more than the deepest contracted neighbour, are added to spread the contraction evenly and keep the hierarchy shallow.
+int computeChPriority(const ChRemainingGraph &graph, Node node, int contractedNeighbours, int depth, WitnessWorkspace &ws) {
+    const int shortcutsCount = findShortcuts(graph, node, ws, nullptr);
+    return 2 * (shortcutsCount - int(graph.inEdges[node].size()) - int(graph.outEdges[node].size())) + contractedNeighbours + depth;
+}
+
+/// Builds a contraction hierarchy of the graph, with the work of each step split among the given number of threads.
+/// Nodes are contracted in rounds. Each round contracts at once all nodes with a lower priority than all their neighbours,
+/// which is an independent set of nodes, and their witness searches avoid all nodes of the round, so they can run in parallel.
+template <typename GraphT>
+ContractionHierarchy buildContractionHierarchy(const GraphT &graph, int threadsCount) {
+    const int nodesCount = int(graph.size());
+    ChRemainingGraph remainingGraph;
+    remainingGraph.outEdges.resize(nodesCount);
+    remainingGraph.inEdges.resize(nodesCount);
+    remainingGraph.removed.assign(nodesCount, false);
+    // Only the shortest of parallel edges matters, and loops never lie on a shortest path
+    for (Node node = 0; node < nodesCount; node++) {
+        for (const Edge &edge : graph[node]) {
+            if (edge.node != node) {
+                addOrShortenChEdge(remainingGraph.outEdges[node], { edge.node, edge.weight, -1 });
+                addOrShortenChEdge(remainingGraph.inEdges[edge.node], { node, edge.weight, -1 });
+            }
+        }
+    }
+
+    ThreadPool pool(threadsCount);
+    vector<WitnessWorkspace> workspaces;
+    workspaces.reserve(pool.size());
+    for (int threadIdx = 0; threadIdx < pool.size(); threadIdx++) {
+        workspaces.emplace_back(nodesCount);
+    }
+    vector<int> priority(nodesCount);
+    vector<int> contractedNeighbours(nodesCount, 0);
+    vector<int> depth(nodesCount, 0);
+    pool.parallelFor(nodesCount, 256, [&](int threadIdx, int begin, int end) {
+        for (Node node = begin; node < end; node++) {
+            priority[node] = computeChPriority(remainingGraph, node, 0, 0, workspaces[threadIdx]);
+        }
+    });
+
+    ContractionHierarchy ch;
+    ch.rank.assign(nodesCount, -1);
+    vector< vector<ChEdge> > upwardEdges(nodesCount);
+    vector< vector<ChEdge> > reverseUpwardEdges(nodesCount);
+    vector<Node> remaining(nodesCount);
+    for (Node node = 0; node < nodesCount; node++) {
+        remaining[node] = node;
+    }
+    vector<char> selected;
+    vector<Node> contracting;
+    vector< vector< pair<Node, ChEdge> > > shortcuts(pool.size());
+    vector<Node> touched;
+    vector<char> isTouched(nodesCount, false);
+    int nextRank = 0;
+    while (!remaining.empty()) {
+        // Select the nodes whose priority is lower than the priority of all their neighbours, with ties broken by node number
+        selected.assign(remaining.size(), false);
+        pool.parallelFor(int(remaining.size()), 1024, [&](int, int begin, int end) {
+            for (int idx = begin; idx < end; idx++) {
+                const Node node = remaining[idx];
+                const pair<int, Node> nodeKey = { priority[node], node };
+                bool isMinimum = true;
+                for (const ChEdge &edge : remainingGraph.outEdges[node]) {
+                    isMinimum = isMinimum && nodeKey < make_pair(priority[edge.node], edge.node);
+                }
+                for (const ChEdge &edge : remainingGraph.inEdges[node]) {
+                    isMinimum = isMinimum && nodeKey < make_pair(priority[edge.node], edge.node);
+                }
+                selected[idx] = isMinimum;
+            }
+        });
+        contracting.clear();
+        for (int idx = 0; idx < int(remaining.size()); idx++) {
+            if (selected[idx]) {
+                contracting.push_back(remaining[idx]);
+                remainingGraph.removed[remaining[idx]] = true;
+                ch.rank[remaining[idx]] = nextRank++;
+            }
+        }
+
+        // Contract the selected nodes in parallel. The remaining graph is only read here, and each thread collects its own shortcuts.
+        // All neighbours of a contracted node are ranked higher, so its remaining edges are exactly its upward edges.
+        pool.parallelFor(int(contracting.size()), 16, [&](int threadIdx, int begin, int end) {
+            for (int idx = begin; idx < end; idx++) {
+                const Node node = contracting[idx];
+                findShortcuts(remainingGraph, node, workspaces[threadIdx], &shortcuts[threadIdx]);
+                upwardEdges[node].swap(remainingGraph.outEdges[node]);
+                reverseUpwardEdges[node].swap(remainingGraph.inEdges[node]);
+            }
+        });
+        for (vector< pair<Node, ChEdge> > &threadShortcuts : shortcuts) {
+            for (const pair<Node, ChEdge> &shortcut : threadShortcuts) {
+                addOrShortenChEdge(remainingGraph.outEdges[shortcut.first], shortcut.second);
+                addOrShortenChEdge(remainingGraph.inEdges[shortcut.second.node], { shortcut.first, shortcut.second.weight, shortcut.second.middle });
+            }
+            threadShortcuts.clear();
+        }
+
+        // Remove the contracted nodes from the edges of their neighbours and update the priorities of the neighbours
+        touched.clear();
+        for (const Node node : contracting) {
+            for (const vector<ChEdge> *edges : { &upwardEdges[node], &reverseUpwardEdges[node] }) {
+                for (const ChEdge &edge : *edges) {
+                    contractedNeighbours[edge.node]++;
+                    depth[edge.node] = max(depth[edge.node], depth[node] + 1);
+                    if (!isTouched[edge.node]) {
+                        isTouched[edge.node] = true;
+                        touched.push_back(edge.node);
+                    }
+                }
+            }
+        }
+        const auto isRemoved = [&](const ChEdge &edge) { return remainingGraph.removed[edge.node] != 0; };
+        pool.parallelFor(int(touched.size()), 64, [&](int, int begin, int end) {
+            for (int idx = begin; idx < end; idx++) {
+                vector<ChEdge> &outEdges = remainingGraph.outEdges[touched[idx]];
+                vector<ChEdge> &inEdges = remainingGraph.inEdges[touched[idx]];
+                outEdges.erase(remove_if(outEdges.begin(), outEdges.end(), isRemoved), outEdges.end());
+                inEdges.erase(remove_if(inEdges.begin(), inEdges.end(), isRemoved), inEdges.end());
+            }
+        });
+        pool.parallelFor(int(touched.size()), 16, [&](int threadIdx, int begin, int end) {
+            for (int idx = begin; idx < end; idx++) {
+                const Node node = touched[idx];
+                priority[node] = computeChPriority(remainingGraph, node, contractedNeighbours[node], depth[node], workspaces[threadIdx]);
+                isTouched[node] = false;
+            }
+        });
+        remaining.erase(remove_if(remaining.begin(), remaining.end(), [&](Node node) { return remainingGraph.removed[node] != 0; }),
+                        remaining.end());
+    }
+    ch.upward = buildCsr(upwardEdges);
+    ch.reverseUpward = buildCsr(reverseUpwardEdges);
+    // Every edge is stored once, at its lower ranked node
+    for (const CsrGraph<ChEdge> *chGraph : { &ch.upward, &ch.reverseUpward }) {
+        for (const ChEdge &edge : chGraph->targets) {
+            ch.shortcutsCount += (edge.middle != -1);
+        }
+    }
+    return ch;
+}
+
+/// Memory for contraction hierarchy queries that is kept by the caller and reused across queries on the same hierarchy.
+struct ChWorkspace {
+    ChWorkspace(int nodesCount)
+        : forwardParent(nodesCount, { -1, DIST_INF })
+        , backwardParent(nodesCount, { -1, DIST_INF })
+        , forwardQueue(nodesCount)
+        , backwardQueue(nodesCount)
+    {}
+
+    EpochArray<Edge> forwardParent;
+    EpochArray<Edge> backwardParent;
+    DijkstraHeap forwardQueue;
+    DijkstraHeap backwardQueue;
+};
+
+// Settles the next node of one side of a contraction hierarchy query and relaxes its upward edges.
+// A side stops as soon as its next node is not closer than the best distance found, as going further up cannot make it shorter.
+// The node is stalled, without relaxing its edges, if one of its higher neighbours on the other graph, which has the edges
+// coming to it from above, already has a shorter way to it. Its distance is then too long, so it cannot be on a shortest path.
+void settleChNode(const CsrGraph<ChEdge> &graph, const CsrGraph<ChEdge> &otherGraph, DijkstraHeap &queue, EpochArray<Edge> &parent,
+                  const EpochArray<Edge> &otherParent, int &bestDist, Node &meetNode) {
+    const Node curr = queue.popMin();
+    const int currDist = parent[curr].weight;
+    if (currDist >= bestDist) {
+        queue.clear();
+        return;
+    }
+    const int otherDist = otherParent[curr].weight;
+    if (otherDist != DIST_INF && currDist + otherDist < bestDist) {
+        bestDist = currDist + otherDist;
+        meetNode = curr;
+    }
+    for (const ChEdge &edge : otherGraph[curr]) {
+        const int higherDist = parent[edge.node].weight;
+        if (higherDist != DIST_INF && higherDist + edge.weight < currDist) {
+            return;
+        }
+    }
+    for (const ChEdge &edge : graph[curr]) {
+        const int neighDist = currDist + edge.weight;
+        if (neighDist < parent[edge.node].weight) {
+            parent[edge.node] = { curr, neighDist };
+            queue.pushOrDecrease(edge.node, neighDist);
+        }
+    }
+}
+
+/// Contraction hierarchy query, searching upward from the start node and from the goal node, taking turns,
+/// until both sides stop. The shortest path goes up from the start to its highest ranked node and down from there to the goal,
+/// so that node is settled by both sides, and it is stored in meetNode. The workspace parent arrays get filled like
+/// in dijkstraCoreBidirectional(), with the edges of the hierarchy, which may be shortcuts.
+bool chQueryCore(const ContractionHierarchy &ch, Node start, Node goal, ChWorkspace &ws, Node &meetNode) {
+    ws.forwardParent.reset();
+    ws.backwardParent.reset();
+    ws.forwardParent[start] = { -2, 0 };
+    ws.backwardParent[goal] = { -2, 0 };
+    ws.forwardQueue.pushOrDecrease(start, 0);
+    ws.backwardQueue.pushOrDecrease(goal, 0);
+    int bestDist = DIST_INF;
+    meetNode = -1;
+    bool forwardTurn = true;
+    while (!ws.forwardQueue.empty() || !ws.backwardQueue.empty()) {
+        if (ws.backwardQueue.empty() || (forwardTurn && !ws.forwardQueue.empty())) {
+            settleChNode(ch.upward, ch.reverseUpward, ws.forwardQueue, ws.forwardParent, ws.backwardParent, bestDist, meetNode);
+        }
+        else {
+            settleChNode(ch.reverseUpward, ch.upward, ws.backwardQueue, ws.backwardParent, ws.forwardParent, bestDist, meetNode);
+        }
+        forwardTurn = !forwardTurn;
+    }
+    return meetNode != -1;
+}
+
+// Returns the edge of the hierarchy from one node to another, which is stored at the lower ranked of the two
+const ChEdge& findChEdge(const ContractionHierarchy &ch, Node from, Node to) {
+    if (ch.rank[from] < ch.rank[to]) {
+        for (const ChEdge &edge : ch.upward[from]) {
+            if (edge.node == to) {
+                return edge;
+            }
+        }
+    }
+    else {
+        for (const ChEdge &edge : ch.reverseUpward[to]) {
+            if (edge.node == from) {
+                return edge;
+            }
+        }
+    }
+    throw runtime_error("Missing edge in contraction hierarchy.");
+}
+
+/// Appends to the path the nodes of the original graph on the hierarchy edge from one node to another, without the first node.
+/// A shortcut is replaced by its two edges through its middle node, repeatedly, until only original edges are left.
+void unpackChEdge(const ContractionHierarchy &ch, Node from, Node to, vector<Node> &path) {
+    // Edges still to unpack, with the next one at the back
+    vector< pair<Node, Node> > stack = { { from, to } };
+    while (!stack.empty()) {
+        const pair<Node, Node> curr = stack.back();
+        stack.pop_back();
+        const Node middle = findChEdge(ch, curr.first, curr.second).middle;
+        if (middle == -1) {
+            path.push_back(curr.second);
+        }
+        else {
+            stack.push_back({ middle, curr.second });
+            stack.push_back({ curr.first, middle });
+        }
+    }
+}
+
+/// Search the shortest path from start node to goal node with the given contraction hierarchy, reusing the given workspace.
+/// The function returns true if a path is found, and fills the path vector with it, in nodes of the original graph.
+bool chQuery(const ContractionHierarchy &ch, Node start, Node goal, vector<Node> &path, ChWorkspace &ws) {
+    Node meetNode;
+    if (!chQueryCore(ch, start, goal, ws, meetNode)) {
+        return false;
+    }
+    // The path in the hierarchy goes up from the start to the meeting node and then down to the goal
+    vector<Node> chPath;
+    tracePath(ws.forwardParent, start, meetNode, chPath);
+    for (Node curr = ws.backwardParent[meetNode].node; curr >= 0; curr = ws.backwardParent[curr].node) {
+        chPath.push_back(curr);
+    }
+    path.assign(1, start);
+    for (int idx = 0; idx + 1 < int(chPath.size()); idx++) {
+        unpackChEdge(ch, chPath[idx], chPath[idx + 1], path);
+    }
+    return true;
+}
+
+// Prints the given path to the console as a list of nodes, separated with commas.
+void printPath(const vector<Node> &path) {
+    for (int i = 0; i < path.size(); i++) {
+        cout << path[i];
+        if (i < path.size() - 1) {
+            cout << ", ";
+        }
+    }
+    cout << "\n";
+}
+
+// Returns a list of weighted edges of a random directed graph with weights uniformly random in [1, maxWeight]
+vector< pair<Node, Edge> > generateRandomWeightedEdges(int nodesCount, int edgesCount, int maxWeight, unsigned seed = 1) {
+    const vector< pair<Node, Node> > plainEdges = generateRandomEdges(nodesCount, edgesCount, seed);
+    mt19937 rng(seed + 1);
+    uniform_int_distribution<int> weightDist(1, maxWeight);
+    vector< pair<Node, Edge> > edges(plainEdges.size());
+    for (int i = 0; i < int(plainEdges.size()); i++) {
+        edges[i] = { plainEdges[i].first, { plainEdges[i].second, weightDist(rng) } };
+    }
+    return edges;
+}
+
+// Returns the weighted edges of a square grid graph with the given side, with weights uniformly random in [1, maxWeight]
+vector< pair<Node, Edge> > generateWeightedGridEdges(int side, int maxWeight, unsigned seed = 1) {
+    const vector< pair<Node, Node> > gridEdges = generateGridEdges(side, side);
+    mt19937 rng(seed);
+    uniform_int_distribution<int> weightDist(1, maxWeight);
+    vector< pair<Node, Edge> > edges(gridEdges.size());
+    for (int idx = 0; idx < int(gridEdges.size()); idx++) {
+        edges[idx] = { gridEdges[idx].first, { gridEdges[idx].second, weightDist(rng) } };
+    }
+    return edges;
+}
+
+// Runs a full single-source Dijkstra from each of the given start nodes and returns the total time in milliseconds.
+// The number of edges traversed is accumulated in edgesTraversed.
+template <typename Queue = DijkstraHeap, typename GraphT>
+double timeFullDijkstra(const GraphT &graph, const vector<Node> &starts, long long &edgesTraversed) {
+    edgesTraversed = 0;
+    vector<Edge> parent(graph.size());
+    vector<bool> visited(graph.size());
+    Queue queue(graph.size());
+    Timer timer;
+    for (const Node start : starts) {
+        fill(parent.begin(), parent.end(), Edge{ -1, DIST_INF });
+        fill(visited.begin(), visited.end(), false);
+        parent[start] = { -2, 0 };
+        dijkstraCore(graph, visited, start, -1, parent, queue);
+        for (Node node = 0; node < int(graph.size()); node++) {
+            if (visited[node]) {
+                edgesTraversed += graph[node].size();
+            }
+        }
+    }
+    return timer.elapsedMs();
+}
+
+// Compares Dijkstra throughput on a random graph stored as nested vectors and as a CSR graph
+void benchCsr(int nodesCount, int avgDegree) {
+    cout << "Dijkstra on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const vector< pair<Node, Edge> > edges = generateRandomWeightedEdges(nodesCount, nodesCount * avgDegree, 100);
+    const vector<Node> starts = generateRandomNodes(nodesCount, 5);
+    const Graph nestedGraph = buildAdjLists(nodesCount, edges);
+    const CsrGraph<Edge> csrGraph = buildCsr(nodesCount, edges);
+
+    long long edgesTraversed;
+    const double nestedMs = timeFullDijkstra(nestedGraph, starts, edgesTraversed);
+    printBenchResult("nested vectors", nestedMs, edgesTraversed);
+    const double csrMs = timeFullDijkstra(csrGraph, starts, edgesTraversed);
+    printBenchResult("CSR", csrMs, edgesTraversed);
+}
+
+// Compares queries with a fresh parent array per query and with a reused workspace, on a graph where each query touches few nodes
+void benchWorkspace(int nodesCount, int avgDegree) {
+    // Most nodes have no edges, so each query stays within the small part of the graph reachable from its start
+    const int activeCount = min(nodesCount, 1000);
+    cout << "Local Dijkstra queries on a graph with " << nodesCount << " nodes, " << activeCount << " of them with edges\n";
+    const CsrGraph<Edge> graph = buildCsr(nodesCount, generateRandomWeightedEdges(activeCount, activeCount * avgDegree, 100));
+    const int queriesCount = 1000;
+    const vector<Node> starts = generateRandomNodes(activeCount, queriesCount, 2);
+    const vector<Node> goals = generateRandomNodes(activeCount, queriesCount, 3);
+
+    vector<Node> path;
+    int foundCount = 0;
+    Timer timer;
+    for (int query = 0; query < queriesCount; query++) {
+        foundCount += dijkstra(graph, starts[query], goals[query], path);
+    }
+    cout << "  fresh arrays: " << timer.elapsedMs() * 1000.0 / queriesCount << " us/query, " << foundCount << " found\n";
+
+    DijkstraWorkspace workspace(graph.size());
+    foundCount = 0;
+    timer.restart();
+    for (int query = 0; query < queriesCount; query++) {
+        foundCount += dijkstra(graph, starts[query], goals[query], path, workspace);
+    }
+    cout << "  reused workspace: " << timer.elapsedMs() * 1000.0 / queriesCount << " us/query, " << foundCount << " found\n";
+}
+
+// Measures full Dijkstra searches on a weighted grid graph with shuffled node numbers, in its given order and in each locality order
+void benchReorder(int nodesCount) {
+    int side = 1;
+    while ((side + 1) * (side + 1) <= nodesCount) {
+        side++;
+    }
+    const vector< pair<Node, Edge> > edges = generateWeightedGridEdges(side, 100);
+    mt19937 rng(1);
+    vector<Node> shuffledOrder(side * side);
+    for (Node node = 0; node < side * side; node++) {
+        shuffledOrder[node] = node;
+    }
+    shuffle(shuffledOrder.begin(), shuffledOrder.end(), rng);
+    const CsrGraph<Edge> graph = reorderGraph(buildCsr(side * side, edges), makeNodeOrder(shuffledOrder));
+    cout << "Dijkstra on a shuffled grid graph with " << graph.size() << " nodes\n";
+
+    const vector<Node> starts = generateRandomNodes(graph.size(), 3);
+    long long edgesTraversed;
+    const double givenMs = timeFullDijkstra(graph, starts, edgesTraversed);
+    printBenchResult("given order", givenMs, edgesTraversed);
+    const char *orderNames[] = { "degree order", "BFS order", "RCM order" };
+    for (int orderIdx = 0; orderIdx < 3; orderIdx++) {
+        const NodeOrder order = (orderIdx == 0) ? computeDegreeOrder(graph)
+                              : (orderIdx == 1) ? computeBfsOrder(graph)
+                              : computeRcmOrder(graph);
+        const CsrGraph<Edge> reordered = reorderGraph(graph, order);
+        vector<Node> newStarts(starts.size());
+        for (int idx = 0; idx < int(starts.size()); idx++) {
+            newStarts[idx] = order.toNew[starts[idx]];
+        }
+        const double dijkstraMs = timeFullDijkstra(reordered, newStarts, edgesTraversed);
+        printBenchResult(orderNames[orderIdx], dijkstraMs, edgesTraversed);
+        cout << "    speedup " << givenMs / dijkstraMs << "\n";
+    }
+}
+
+// Queue policy that forwards to another queue and counts the operations done on it
+template <typename Queue>
+struct CountingQueue {
+    CountingQueue(int nodesCount)
+        : queue(nodesCount)
+    {}
+
+    bool empty() const {
+        return queue.empty();
+    }
+
+    void pushOrDecrease(Node node, int key) {
+        operationsCount++;
+        queue.pushOrDecrease(node, key);
+    }
+
+    Node popMin() {
+        operationsCount++;
+        return queue.popMin();
+    }
+
+    void clear() {
+        queue.clear();
+    }
+
+    Queue queue;
+    long long operationsCount = 0;
+};
+
+// Dijkstra with a binary heap of lazy duplicates and no early exit, as a baseline for the indexed heap.
+// A node is pushed again every time its distance improves, and the stale entries are skipped when popped.
+// Returns the number of heap operations.
+template <typename GraphT>
+long long dijkstraLazyBaseline(const GraphT &graph, Node start, vector<Edge> &parent) {
+    long long operationsCount = 1;
+    vector<bool> visited(graph.size(), false);
+    // Edges compare by decreasing weight, so the queue pops the smallest tentative distance first
+    priority_queue<Edge> prQu;
+    prQu.push({ start, 0 });
+    while (!prQu.empty()) {
+        const Edge curr = prQu.top();
+        prQu.pop();
+        operationsCount++;
+        if (visited[curr.node]) {
+            continue;
+        }
+        visited[curr.node] = true;
+        for (const Edge &neigh : graph[curr.node]) {
+            const int neighDist = curr.weight + neigh.weight;
+            if (!visited[neigh.node] && neighDist < parent[neigh.node].weight) {
+                parent[neigh.node] = { curr.node, neighDist };
+                prQu.push({ neigh.node, neighDist });
+                operationsCount++;
+            }
+        }
+    }
+    return operationsCount;
+}
+
+// Compares point-to-point queries with the lazy binary heap without early exit and with the indexed 4-ary heap with early exit
+void benchHeap(int nodesCount, int avgDegree) {
+    cout << "Point-to-point Dijkstra on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const CsrGraph<Edge> graph = buildCsr(nodesCount, generateRandomWeightedEdges(nodesCount, nodesCount * avgDegree, 100));
+    const int queriesCount = 20;
+    const vector<Node> starts = generateRandomNodes(nodesCount, queriesCount, 2);
+    const vector<Node> goals = generateRandomNodes(nodesCount, queriesCount, 3);
+
+    vector<Edge> parent(graph.size());
+    vector<int> lazyDists(queriesCount);
+    long long operationsCount = 0;
+    Timer timer;
+    for (int query = 0; query < queriesCount; query++) {
+        fill(parent.begin(), parent.end(), Edge{ -1, DIST_INF });
+        parent[starts[query]] = { -2, 0 };
+        operationsCount += dijkstraLazyBaseline(graph, starts[query], parent);
+        lazyDists[query] = parent[goals[query]].weight;
+    }
+    cout << "  lazy binary heap: " << timer.elapsedMs() / queriesCount << " ms/query, "
+         << operationsCount / queriesCount << " heap operations/query\n";
+
+    vector<bool> visited(graph.size());
+    CountingQueue<DijkstraHeap> queue(graph.size());
+    bool sameDists = true;
+    timer.restart();
+    for (int query = 0; query < queriesCount; query++) {
+        fill(parent.begin(), parent.end(), Edge{ -1, DIST_INF });
+        fill(visited.begin(), visited.end(), false);
+        parent[starts[query]] = { -2, 0 };
+        dijkstraCore(graph, visited, starts[query], goals[query], parent, queue);
+        sameDists = sameDists && (parent[goals[query]].weight == lazyDists[query]);
+    }
+    cout << "  indexed 4-ary heap: " << timer.elapsedMs() / queriesCount << " ms/query, "
+         << queue.operationsCount / queriesCount << " heap operations/query, "
+         << (sameDists ? "same distances" : "DIFFERENT distances") << "\n";
+}
+
+// Compares full Dijkstra searches with the indexed 4-ary heap, the radix heap and Dial's bucket queue on the given graph
+void benchQueuesOn(const CsrGraph<Edge> &graph) {
+    const vector<Node> starts = generateRandomNodes(graph.size(), 5);
+    long long edgesTraversed;
+    const double heapMs = timeFullDijkstra<DijkstraHeap>(graph, starts, edgesTraversed);
+    printBenchResult("indexed 4-ary heap", heapMs, edgesTraversed);
+    const double radixMs = timeFullDijkstra<RadixHeap>(graph, starts, edgesTraversed);
+    printBenchResult("radix heap", radixMs, edgesTraversed);
+    cout << "    speedup " << heapMs / radixMs << "\n";
+    const double dialMs = timeFullDijkstra< DialQueue<100> >(graph, starts, edgesTraversed);
+    printBenchResult("Dial buckets", dialMs, edgesTraversed);
+    cout << "    speedup " << heapMs / dialMs << "\n";
+
+    const vector<int> heapDists = fullDijkstraDists<DijkstraHeap>(graph, starts[0]);
+    const bool sameDists = heapDists == fullDijkstraDists<RadixHeap>(graph, starts[0])
+                        && heapDists == fullDijkstraDists< DialQueue<100> >(graph, starts[0]);
+    cout << "  " << (sameDists ? "same distances" : "DIFFERENT distances") << "\n";
+}
+
+// Compares the queue policies on a random graph and on a grid graph, both with integer weights in [1, 100]
+void benchQueues(int nodesCount, int avgDegree) {
+    cout << "Dijkstra queues on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    benchQueuesOn(buildCsr(nodesCount, generateRandomWeightedEdges(nodesCount, nodesCount * avgDegree, 100)));
+
+    int side = 1;
+    while ((side + 1) * (side + 1) <= nodesCount) {
+        side++;
+    }
+    const vector< pair<Node, Edge> > edges = generateWeightedGridEdges(side, 100);
+    cout << "Dijkstra queues on a grid graph with " << side * side << " nodes\n";
+    benchQueuesOn(buildCsr(side * side, edges));
+}
+
+// Compares point-to-point queries with the unidirectional and the bidirectional Dijkstra on the given graph,
+// by time and by the number of nodes settled per query
+void benchBidirectionalOn(const CsrGraph<Edge> &graph) {
+    const CsrGraph<Edge> reverseGraph = buildReverseCsr(graph);
+    const int queriesCount = 20;
+    const vector<Node> starts = generateRandomNodes(graph.size(), queriesCount, 2);
+    const vector<Node> goals = generateRandomNodes(graph.size(), queriesCount, 3);
+
+    vector<Edge> parent(graph.size());
+    vector<bool> visited(graph.size());
+    vector<int> dists(queriesCount);
+    long long settledCount = 0;
+    Timer timer;
+    for (int query = 0; query < queriesCount; query++) {
+        fill(parent.begin(), parent.end(), Edge{ -1, DIST_INF });
+        fill(visited.begin(), visited.end(), false);
+        parent[starts[query]] = { -2, 0 };
+        dijkstraCore(graph, visited, starts[query], goals[query], parent);
+        dists[query] = parent[goals[query]].weight;
+        settledCount += count(visited.begin(), visited.end(), true);
+    }
+    const double unidirMs = timer.elapsedMs();
+    cout << "  unidirectional: " << unidirMs / queriesCount << " ms/query, " << settledCount / queriesCount << " settled nodes/query\n";
+
+    vector<Edge> backwardParent(graph.size());
+    vector<bool> backwardVisited(graph.size());
+    bool sameDists = true;
+    settledCount = 0;
+    timer.restart();
+    for (int query = 0; query < queriesCount; query++) {
+        fill(parent.begin(), parent.end(), Edge{ -1, DIST_INF });
+        fill(backwardParent.begin(), backwardParent.end(), Edge{ -1, DIST_INF });
+        fill(visited.begin(), visited.end(), false);
+        fill(backwardVisited.begin(), backwardVisited.end(), false);
+        parent[starts[query]] = { -2, 0 };
+        backwardParent[goals[query]] = { -2, 0 };
+        Node meetNode;
+        const bool found = dijkstraCoreBidirectional(graph, reverseGraph, starts[query], goals[query], visited, backwardVisited,
+                                                     parent, backwardParent, meetNode);
+        const int dist = found ? parent[meetNode].weight + backwardParent[meetNode].weight : DIST_INF;
+        sameDists = sameDists && (dist == dists[query]);
+        settledCount += count(visited.begin(), visited.end(), true) + count(backwardVisited.begin(), backwardVisited.end(), true);
+    }
+    const double bidirMs = timer.elapsedMs();
+    cout << "  bidirectional: " << bidirMs / queriesCount << " ms/query, " << settledCount / queriesCount << " settled nodes/query, "
+         << (sameDists ? "same distances" : "DIFFERENT distances") << "\n";
+    cout << "    speedup " << unidirMs / bidirMs << "\n";
+}
+
+// Compares the unidirectional and the bidirectional Dijkstra on a grid graph, which is similar to a road network, and on a random graph
+void benchBidirectional(int nodesCount, int avgDegree) {
+    int side = 1;
+    while ((side + 1) * (side + 1) <= nodesCount) {
+        side++;
+    }
+    cout << "Bidirectional Dijkstra on a grid graph with " << side * side << " nodes\n";
+    benchBidirectionalOn(buildCsr(side * side, generateWeightedGridEdges(side, 100)));
+    cout << "Bidirectional Dijkstra on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    benchBidirectionalOn(buildCsr(nodesCount, generateRandomWeightedEdges(nodesCount, nodesCount * avgDegree, 100)));
+}
+
+// Compares point-to-point queries with plain Dijkstra and with ALT for each landmark selection on the given graph,
+// by time and by the number of nodes settled per query
+void benchAltOn(const CsrGraph<Edge> &graph, int landmarksCount) {
+    const CsrGraph<Edge> reverseGraph = buildReverseCsr(graph);
+    const int queriesCount = 20;
+    const vector<Node> starts = generateRandomNodes(graph.size(), queriesCount, 2);
+    const vector<Node> goals = generateRandomNodes(graph.size(), queriesCount, 3);
+
+    vector<Edge> parent(graph.size());
+    vector<bool> visited(graph.size());
+    vector<int> dists(queriesCount);
+    long long settledCount = 0;
+    Timer timer;
+    for (int query = 0; query < queriesCount; query++) {
+        fill(parent.begin(), parent.end(), Edge{ -1, DIST_INF });
+        fill(visited.begin(), visited.end(), false);
+        parent[starts[query]] = { -2, 0 };
+        dijkstraCore(graph, visited, starts[query], goals[query], parent);
+        dists[query] = parent[goals[query]].weight;
+        settledCount += count(visited.begin(), visited.end(), true);
+    }
+    const double plainMs = timer.elapsedMs();
+    cout << "  plain Dijkstra: " << plainMs / queriesCount << " ms/query, " << settledCount / queriesCount << " settled nodes/query\n";
+
+    const char *selectionNames[] = { "farthest", "avoid" };
+    for (int selection = LANDMARKS_FARTHEST; selection <= LANDMARKS_AVOID; selection++) {
+        timer.restart();
+        const Landmarks landmarks = buildLandmarks(graph, reverseGraph, landmarksCount, LandmarkSelection(selection));
+        cout << "  " << landmarksCount << " " << selectionNames[selection] << " landmarks built in " << timer.elapsedMs() << " ms, "
+             << landmarks.dists.size() * sizeof(int) / (1024.0 * 1024.0) << " MB\n";
+        bool sameDists = true;
+        settledCount = 0;
+        timer.restart();
+        for (int query = 0; query < queriesCount; query++) {
+            fill(parent.begin(), parent.end(), Edge{ -1, DIST_INF });
+            fill(visited.begin(), visited.end(), false);
+            parent[starts[query]] = { -2, 0 };
+            const bool found = dijkstraCoreAlt(graph, landmarks.view(), visited, starts[query], goals[query], parent);
+            // The reduced distance of the goal is short by the lower bound from the start
+            const int dist = found ? parent[goals[query]].weight + landmarkLowerBound(landmarks.view(), starts[query], goals[query]) : DIST_INF;
+            sameDists = sameDists && (dist == dists[query]);
+            settledCount += count(visited.begin(), visited.end(), true);
+        }
+        const double altMs = timer.elapsedMs();
+        cout << "  ALT " << selectionNames[selection] << ": " << altMs / queriesCount << " ms/query, "
+             << settledCount / queriesCount << " settled nodes/query, " << (sameDists ? "same distances" : "DIFFERENT distances") << "\n";
+        cout << "    speedup " << plainMs / altMs << "\n";
+    }
+}
+
+// Compares plain Dijkstra and ALT on a grid graph, which is similar to a road network, and on a random graph
+void benchAlt(int nodesCount, int avgDegree, int landmarksCount) {
+    int side = 1;
+    while ((side + 1) * (side + 1) <= nodesCount) {
+        side++;
+    }
+    cout << "ALT on a grid graph with " << side * side << " nodes\n";
+    benchAltOn(buildCsr(side * side, generateWeightedGridEdges(side, 100)), landmarksCount);
+    cout << "ALT on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    benchAltOn(buildCsr(nodesCount, generateRandomWeightedEdges(nodesCount, nodesCount * avgDegree, 100)), landmarksCount);
+}
+
+// Measures building a contraction hierarchy of a grid graph, which is similar to a road network, and compares its queries with Dijkstra
+void benchContractionHierarchy(int nodesCount, int threadsCount) {
+    int side = 1;
+    while ((side + 1) * (side + 1) <= nodesCount) {
+        side++;
+    }
+    const CsrGraph<Edge> graph = buildCsr(side * side, generateWeightedGridEdges(side, 100));
+    cout << "Contraction hierarchy of a grid graph with " << graph.size() << " nodes and " << graph.edgesCount() << " edges\n";
+    Timer timer;
+    const ContractionHierarchy ch = buildContractionHierarchy(graph, threadsCount);
+    cout << "  built with " << threadsCount << " threads in " << timer.elapsedMs() << " ms, " << ch.shortcutsCount << " shortcuts\n";
+
+    const int queriesCount = 1000;
+    const vector<Node> starts = generateRandomNodes(graph.size(), queriesCount, 2);
+    const vector<Node> goals = generateRandomNodes(graph.size(), queriesCount, 3);
+    // Dijkstra is much slower, so it answers only some of the queries
+    const int dijkstraQueriesCount = 20;
+    DijkstraWorkspace dijkstraWorkspace(graph.size());
+    vector<int> dists(dijkstraQueriesCount);
+    vector<Node> path;
+    timer.restart();
+    for (int query = 0; query < dijkstraQueriesCount; query++) {
+        dijkstra(graph, starts[query], goals[query], path, dijkstraWorkspace);
+        dists[query] = dijkstraWorkspace.parent[goals[query]].weight;
+    }
+    cout << "  Dijkstra: " << timer.elapsedMs() * 1000.0 / dijkstraQueriesCount << " us/query\n";
+
+    ChWorkspace chWorkspace(graph.size());
+    bool samePaths = true;
+    timer.restart();
+    for (int query = 0; query < queriesCount; query++) {
+        chQuery(ch, starts[query], goals[query], path, chWorkspace);
+        // The unpacked path must be a path of the graph with the same length as the one found by Dijkstra
+        if (query < dijkstraQueriesCount) {
+            long long pathDist = 0;
+            for (int idx = 0; idx + 1 < int(path.size()); idx++) {
+                int edgeWeight = DIST_INF;
+                for (const Edge &edge : graph[path[idx]]) {
+                    if (edge.node == path[idx + 1]) {
+                        edgeWeight = min(edgeWeight, edge.weight);
+                    }
+                }
+                pathDist += edgeWeight;
+            }
+            samePaths = samePaths && path.front() == starts[query] && path.back() == goals[query] && pathDist == dists[query];
+        }
+    }
+    cout << "  contraction hierarchy: " << timer.elapsedMs() * 1000.0 / queriesCount << " us/query, "
+         << (samePaths ? "same path lengths" : "DIFFERENT path lengths") << "\n";
+}
+
+// Returns true if the two parent arrays have the same distances and every parent of the second one is on a shortest path,
+// so it is as good a parent as the one in the first array, which may differ only between paths of the same length
+template <typename GraphT>
+bool sameShortestPaths(const GraphT &graph, const vector<Edge> &parent, const vector<Edge> &otherParent) {
+    for (Node node = 0; node < graph.size(); node++) {
+        if (parent[node].weight != otherParent[node].weight) {
+            return false;
+        }
+        const Node parentNode = otherParent[node].node;
+        if (parentNode >= 0) {
+            bool onShortestPath = false;
+            for (const Edge &edge : graph[parentNode]) {
+                onShortestPath = onShortestPath || (edge.node == node && otherParent[parentNode].weight + edge.weight == otherParent[node].weight);
+            }
+            if (!onShortestPath) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Returns true if the parents form a tree rooted at the start, with -2 as the parent of the start,
+// so following the parents from any reached node ends at the start without going around a cycle
+bool isParentTree(const vector<Edge> &parent, Node start) {
+    if (parent[start].node != -2 || parent[start].weight != 0) {
+        return false;
+    }
+    // Nodes already known to lead to the start are marked with 1, and the ones on the chain being followed with 2
+    vector<char> state(parent.size(), 0);
+    state[start] = 1;
+    vector<Node> chain;
+    for (Node node = 0; node < int(parent.size()); node++) {
+        chain.clear();
+        Node curr = node;
+        while (curr >= 0 && state[curr] == 0) {
+            state[curr] = 2;
+            chain.push_back(curr);
+            curr = parent[curr].node;
+        }
+        // A chain that ends on a node of itself is a cycle, and an unreached node has -1 as a parent
+        if (curr >= 0 && state[curr] == 2) {
+            return false;
+        }
+        for (const Node chainNode : chain) {
+            state[chainNode] = 1;
+        }
+    }
+    return true;
+}
+
+// Measures full single-source searches with delta-stepping on 1, 2, 4, ... threads up to the number of cores,
+// compared with the sequential Dijkstra on the given graph
+void benchDeltaSteppingOn(const CsrGraph<Edge> &graph, int delta) {
+    const vector<Node> starts = generateRandomNodes(graph.size(), 3);
+
+    vector<Edge> sequentialParent(graph.size(), { -1, DIST_INF });
+    vector<bool> visited(graph.size(), false);
+    sequentialParent[starts[0]] = { -2, 0 };
+    dijkstraCore(graph, visited, starts[0], -1, sequentialParent);
+    long long edgesTraversed;
+    const double sequentialMs = timeFullDijkstra(graph, starts, edgesTraversed);
+    printBenchResult("sequential Dijkstra", sequentialMs, edgesTraversed);
+
+    const int maxThreads = max(int(thread::hardware_concurrency()), 1);
+    vector<Edge> parent;
+    for (int threadsCount = 1; ; threadsCount = min(threadsCount * 2, maxThreads)) {
+        ThreadPool pool(threadsCount);
+        Timer timer;
+        for (const Node start : starts) {
+            deltaStepping(graph, start, delta, parent, pool);
+        }
+        const double parallelMs = timer.elapsedMs();
+        deltaStepping(graph, starts[0], delta, parent, pool);
+        const string name = "delta-stepping, " + to_string(threadsCount) + " threads";
+        printBenchResult(name.c_str(), parallelMs, edgesTraversed);
+        cout << "    speedup " << sequentialMs / parallelMs << ", "
+             << (sameShortestPaths(graph, sequentialParent, parent) ? "same distances" : "DIFFERENT distances") << ", "
+             << (isParentTree(parent, starts[0]) ? "valid parent tree" : "INVALID parent tree") << "\n";
+        if (threadsCount == maxThreads) {
+            break;
+        }
+    }
+}
+
+// Compares delta-stepping with the sequential Dijkstra on a random graph with weights in [1, 100],
+// and on one with weights in [0, 3], where the many zero-weight edges and equal distances test the ties between parents
+void benchDeltaStepping(int nodesCount, int avgDegree, int delta) {
+    cout << "Delta-stepping with delta " << delta << " on a random graph with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    benchDeltaSteppingOn(buildCsr(nodesCount, generateRandomWeightedEdges(nodesCount, nodesCount * avgDegree, 100)), delta);
+
+    cout << "Delta-stepping with delta " << delta << " on the same graph with weights in [0, 3]\n";
+    vector< pair<Node, Edge> > edges = generateRandomWeightedEdges(nodesCount, nodesCount * avgDegree, 4);
+    for (pair<Node, Edge> &edge : edges) {
+        edge.second.weight--;
+    }
+    benchDeltaSteppingOn(buildCsr(nodesCount, edges), delta);
+}
+
+// Compares a distance table between random sources and targets on a grid computed with one dijkstra() call per pair,
+// with one one-to-many search per source, and with the parallel many-to-many query
+void benchDistanceTable(int nodesCount, int count) {
+    int side = 1;
+    while ((side + 1) * (side + 1) <= nodesCount) {
+        side++;
+    }
+    cout << "Distance table of " << count << " x " << count << " nodes on a " << side << " x " << side << " grid\n";
+    const CsrGraph<Edge> graph = buildCsr(side * side, generateWeightedGridEdges(side, 100));
+    const vector<Node> sources = generateRandomNodes(graph.size(), count, 2);
+    const vector<Node> targets = generateRandomNodes(graph.size(), count, 3);
+
+    // A search per pair takes long, so only the first row is timed and the whole table is estimated from it
+    vector<Node> path;
+    Timer timer;
+    for (const Node target : targets) {
+        dijkstra(graph, sources[0], target, path);
+    }
+    const double pairwiseMs = timer.elapsedMs() * count;
+    cout << "    one search per pair:  " << pairwiseMs << " ms (estimated from the first row)\n";
+
+    vector<int> oneToManyTable(size_t(count) * count);
+    DistanceTableWorkspace ws(graph.size());
+    timer.restart();
+    for (int sourceIdx = 0; sourceIdx < count; sourceIdx++) {
+        dijkstraOneToMany(graph, sources[sourceIdx], targets, oneToManyTable.data() + size_t(sourceIdx) * count, ws);
+    }
+    const double oneToManyMs = timer.elapsedMs();
+    cout << "    one-to-many per row:  " << oneToManyMs << " ms, speedup " << pairwiseMs / oneToManyMs << "\n";
+
+    const int threadsCount = max(int(thread::hardware_concurrency()), 1);
+    ThreadPool pool(threadsCount);
+    vector<DistanceTableWorkspace> workspaces(pool.size(), DistanceTableWorkspace(graph.size()));
+    vector<int> table;
+    timer.restart();
+    dijkstraManyToMany(graph, sources, targets, table, pool, workspaces);
+    const double manyToManyMs = timer.elapsedMs();
+    cout << "    many-to-many, " << threadsCount << " threads: " << manyToManyMs << " ms, speedup " << pairwiseMs / manyToManyMs << ", "
+         << ((table == oneToManyTable) ? "same table" : "DIFFERENT table") << "\n";
+
+    // Check the first row against the distances of full searches
+    const vector<int> dists = fullDijkstraDists(graph, sources[0]);
+    bool sameRow = true;
+    for (int targetIdx = 0; targetIdx < count; targetIdx++) {
+        sameRow = sameRow && (table[targetIdx] == dists[targets[targetIdx]]);
+    }
+    cout << "    first row " << (sameRow ? "matches" : "DOES NOT match") << " a full search\n";
+}
+
+// Returns the weighted edges of a random directed acyclic graph, made of a random graph with every edge turned
+// to go from the earlier to the later node of a random order of the nodes, and with self-loops dropped
+vector< pair<Node, Edge> > generateRandomDagEdges(int nodesCount, int edgesCount, int maxWeight, unsigned seed = 1) {
+    vector<int> rank(nodesCount);
+    for (Node node = 0; node < nodesCount; node++) {
+        rank[node] = node;
+    }
+    shuffle(rank.begin(), rank.end(), mt19937(seed + 2));
+    vector< pair<Node, Edge> > edges;
+    for (const pair<Node, Edge> &edge : generateRandomWeightedEdges(nodesCount, edgesCount, maxWeight, seed)) {
+        if (rank[edge.first] < rank[edge.second.node]) {
+            edges.push_back(edge);
+        }
+        else if (rank[edge.first] > rank[edge.second.node]) {
+            edges.push_back({ edge.second.node, { edge.first, edge.second.weight } });
+        }
+    }
+    return edges;
+}
+
+// Compares full searches on a random DAG with Dijkstra and with relaxation in topological order
+void benchDag(int nodesCount, int avgDegree) {
+    cout << "Shortest paths on a random DAG with " << nodesCount << " nodes and average degree " << avgDegree << "\n";
+    const CsrGraph<Edge> graph = buildCsr(nodesCount, generateRandomDagEdges(nodesCount, nodesCount * avgDegree, 100));
+
+    Timer timer;
+    const DagOrder dag = computeDagOrder(graph);
+    cout << "    topological order: " << timer.elapsedMs() << " ms, " << (dag.isDag ? "acyclic" : "NOT acyclic") << "\n";
+    // Random nodes reach little of a random DAG, so the searches start from the first nodes of the order, which reach most of it
+    const vector<Node> starts(dag.order.begin(), dag.order.begin() + min(nodesCount, 5));
+
+    long long edgesTraversed;
+    const double dijkstraMs = timeFullDijkstra(graph, starts, edgesTraversed);
+    printBenchResult("Dijkstra", dijkstraMs, edgesTraversed);
+
+    vector<Edge> parent(graph.size());
+    timer.restart();
+    for (const Node start : starts) {
+        fill(parent.begin(), parent.end(), Edge{ -1, DIST_INF });
+        parent[start] = { -2, 0 };
+        dagShortestPaths(graph, dag, start, -1, parent);
+    }
+    const double dagMs = timer.elapsedMs();
+    printBenchResult("topological relaxation", dagMs, edgesTraversed);
+
+    // The last search of each is compared, and the parents may differ only between paths of the same length
+    vector<Edge> dijkstraParent(graph.size(), { -1, DIST_INF });
+    vector<bool> visited(graph.size(), false);
+    dijkstraParent[starts.back()] = { -2, 0 };
+    dijkstraCore(graph, visited, starts.back(), -1, dijkstraParent);
+    cout << "    speedup " << dijkstraMs / dagMs << ", "
+         << (sameShortestPaths(graph, dijkstraParent, parent) ? "same distances" : "DIFFERENT distances") << "\n";
+}
+
+// Measures repairing the shortest paths from one source on a grid after each of a series of random edge changes,
+// compared with a full Dijkstra search after each change, which is timed after a few of the changes only
+void benchDynamic(int nodesCount, int changesCount) {
+    int side = 1;
+    while ((side + 1) * (side + 1) <= nodesCount) {
+        side++;
+    }
+    cout << "Shortest path repair after " << changesCount << " edge changes on a grid graph with " << side * side << " nodes\n";
+    DynamicGraph graph(side * side, generateWeightedGridEdges(side, 100));
+    DynamicShortestPaths paths(graph, generateRandomNodes(graph.size(), 1)[0]);
+
+    mt19937 rng(3);
+    uniform_int_distribution<Node> nodeDist(0, graph.size() - 1);
+    uniform_int_distribution<int> weightDist(1, 100);
+    vector< pair<Node, Edge> > removedEdges;
+    const int checkEvery = max(changesCount / 10, 1);
+    long long searchedCount = 0;
+    double repairMs = 0.0;
+    double fullMs = 0.0;
+    int checksCount = 0;
+    bool sameDistances = true;
+    vector<Edge> fullParent(graph.size());
+    vector<bool> visited(graph.size());
+    for (int change = 0; change < changesCount; change++) {
+        // Each change reweights or removes a random edge, or inserts back one of the removed edges
+        const int kind = int(rng() % 3);
+        Node from;
+        Node to;
+        int oldWeight;
+        int newWeight;
+        if (kind == 2 && !removedEdges.empty()) {
+            from = removedEdges.back().first;
+            to = removedEdges.back().second.node;
+            oldWeight = DIST_INF;
+            newWeight = removedEdges.back().second.weight;
+            removedEdges.pop_back();
+            graph.insertEdge(from, to, newWeight);
+        }
+        else {
+            from = nodeDist(rng);
+            while (graph[from].empty()) {
+                from = nodeDist(rng);
+            }
+            to = graph[from][rng() % graph[from].size()].node;
+            if (kind == 1) {
+                oldWeight = graph.removeEdge(from, to);
+                newWeight = DIST_INF;
+                removedEdges.push_back({ from, { to, oldWeight } });
+            }
+            else {
+                newWeight = weightDist(rng);
+                oldWeight = graph.reweightEdge(from, to, newWeight);
+            }
+        }
+        Timer timer;
+        searchedCount += paths.edgeChanged(graph, from, to, oldWeight, newWeight);
+        repairMs += timer.elapsedMs();
+
+        if ((change + 1) % checkEvery == 0) {
+            timer.restart();
+            fill(fullParent.begin(), fullParent.end(), Edge{ -1, DIST_INF });
+            fill(visited.begin(), visited.end(), false);
+            fullParent[paths.source] = { -2, 0 };
+            dijkstraCore(graph, visited, paths.source, -1, fullParent);
+            fullMs += timer.elapsedMs();
+            checksCount++;
+            sameDistances = sameDistances && sameShortestPaths(graph, fullParent, paths.parent);
+        }
+    }
+    const double fullSearchMs = fullMs / max(checksCount, 1);
+    cout << "  repair: " << repairMs << " ms in total, " << repairMs * 1000.0 / changesCount << " us/change, "
+         << double(searchedCount) / changesCount << " searched nodes/change\n";
+    cout << "  full search: " << fullSearchMs << " ms/change, " << fullSearchMs * changesCount << " ms in total\n";
+    cout << "    speedup " << fullSearchMs * changesCount / repairMs << ", "
+         << (sameDistances ? "same distances" : "DIFFERENT distances") << " at " << checksCount << " checks\n";
+}
+
+// Runs the benchmark with the given name, with optional size parameters from the command line.
+// Returns false if there is no such benchmark.
+bool runBenchmark(const char *name, int argc, char **argv) {
+    const int nodesCount = (argc > 0) ? atoi(argv[0]) : 1000000;
+    const int avgDegree = (argc > 1) ? atoi(argv[1]) : 8;
+    if (strcmp(name, "csr") == 0) {
+        benchCsr(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "alt") == 0) {
+        benchAlt(nodesCount, avgDegree, (argc > 2) ? atoi(argv[2]) : 16);
+        return true;
+    }
+    if (strcmp(name, "bidir") == 0) {
+        benchBidirectional(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "ch") == 0) {
+        // Preprocessing a grid takes long, so the default graph is smaller than for the other benchmarks
+        benchContractionHierarchy((argc > 0) ? nodesCount : 100000, (argc > 1) ? atoi(argv[1]) : max(int(thread::hardware_concurrency()), 1));
+        return true;
+    }
+    if (strcmp(name, "dag") == 0) {
+        benchDag(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "deltastep") == 0) {
+        const int delta = (argc > 2) ? atoi(argv[2]) : 25;
+        if (delta < 1) {
+            cout << "Invalid delta " << delta << ", it must be at least 1\n";
+            return false;
+        }
+        benchDeltaStepping(nodesCount, avgDegree, delta);
+        return true;
+    }
+    if (strcmp(name, "dynamic") == 0) {
+        benchDynamic(nodesCount, (argc > 1) ? atoi(argv[1]) : 1000);
+        return true;
+    }
+    if (strcmp(name, "heap") == 0) {
+        benchHeap(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "queues") == 0) {
+        benchQueues(nodesCount, avgDegree);
+        return true;
+    }
+    if (strcmp(name, "reorder") == 0) {
+        benchReorder(nodesCount);
+        return true;
+    }
+    if (strcmp(name, "table") == 0) {
+        benchDistanceTable(nodesCount, (argc > 1) ? atoi(argv[1]) : 100);
+        return true;
+    }
+    if (strcmp(name, "workspace") == 0) {
+        benchWorkspace(nodesCount, avgDegree);
+        return true;
+    }
+    cout << "Unknown benchmark " << name << "\n";
+    return false;
+}
+
+// Searches a path between the given nodes of a graph loaded from a binary graph file and prints it.
+// Returns the exit code for main().
+int searchInGraphFile(const char *filepath, Node start, Node goal) {
+    try {
+        Timer timer;
+        const GraphFile file(filepath);
+        const auto graph = file.weightedGraph<Edge>();
+        cout << "Loaded " << graph.size() << " nodes and " << graph.edgesCount() << " edges in " << timer.elapsedMs() << " ms\n";
+        if (start < 0 || start >= graph.size() || goal < 0 || goal >= graph.size()) {
+            cout << "Invalid start or goal node\n";
+            return 1;
+        }
+        vector<Node> path;
+        timer.restart();
+        const bool found = dijkstra(graph, start, goal, path);
+        cout << "Searched in " << timer.elapsedMs() << " ms\n";
+        if (found) {
+            cout << "Path found: ";
+            printPath(path);
+        }
+        else {
+            cout << "No path :(\n";
+        }
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Builds landmarks for a graph loaded from a binary graph file and writes them to a landmark file.
+// Returns the exit code for main().
+int writeLandmarksForGraphFile(const char *graphFilepath, const char *landmarkFilepath, int landmarksCount) {
+    try {
+        Timer timer;
+        const GraphFile file(graphFilepath);
+        // The landmarks need the reverse graph too, so the mapped graph is copied into a CsrGraph to build it
+        const auto view = file.weightedGraph<Edge>();
+        vector< pair<Node, Edge> > edges;
+        edges.reserve(view.edgesCount());
+        for (Node node = 0; node < view.size(); node++) {
+            for (const Edge edge : view[node]) {
+                edges.push_back({ node, edge });
+            }
+        }
+        const CsrGraph<Edge> csrGraph = buildCsr(view.size(), edges);
+        const Landmarks landmarks = buildLandmarks(csrGraph, buildReverseCsr(csrGraph), landmarksCount, LANDMARKS_AVOID);
+        writeLandmarkFile(landmarkFilepath, landmarks.view());
+        cout << "Written " << landmarks.nodes.size() << " landmarks in " << timer.elapsedMs() << " ms\n";
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Searches a path with ALT between the given nodes of a graph loaded from a binary graph file, with landmarks from a landmark file.
+// Returns the exit code for main().
+int searchAltInGraphFile(const char *graphFilepath, const char *landmarkFilepath, Node start, Node goal) {
+    try {
+        Timer timer;
+        const GraphFile file(graphFilepath);
+        const auto graph = file.weightedGraph<Edge>();
+        const LandmarkFile landmarkFile(landmarkFilepath);
+        const LandmarkView landmarks = landmarkFile.view();
+        if (landmarks.nodesCount != graph.size()) {
+            cout << "Landmark file does not match the graph\n";
+            return 1;
+        }
+        cout << "Loaded " << graph.size() << " nodes, " << graph.edgesCount() << " edges and " << landmarks.landmarksCount
+             << " landmarks in " << timer.elapsedMs() << " ms\n";
+        if (start < 0 || start >= graph.size() || goal < 0 || goal >= graph.size()) {
+            cout << "Invalid start or goal node\n";
+            return 1;
+        }
+        vector<Node> path;
+        timer.restart();
+        const bool found = dijkstraAlt(graph, landmarks, start, goal, path);
+        cout << "Searched in " << timer.elapsedMs() << " ms\n";
+        if (found) {
+            cout << "Path found: ";
+            printPath(path);
+        }
+        else {
+            cout << "No path :(\n";
+        }
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Serves queries on a graph loaded from a binary graph file, from stdin or from clients of a Unix socket if its path is given.
+// "dijkstra <start> <goal>" is answered with the distance of the shortest path and its nodes, or -1.
+// Returns the exit code for main().
+int serveGraphFile(const char *filepath, int threadsCount, const char *socketPath) {
+    try {
+        Timer timer;
+        const GraphFile file(filepath);
+        const auto graph = file.weightedGraph<Edge>();
+        ThreadPool pool(threadsCount);
+        // Every thread of the pool searches with its own workspace and path
+        vector<DijkstraWorkspace> workspaces(pool.size(), DijkstraWorkspace(graph.size()));
+        vector< vector<Node> > paths(pool.size());
+        const QueryAnswerer answer = [&](int threadIdx, const char *line, string &result) {
+            NodeQuery query;
+            if (!parseNodeQuery(line, graph.size(), query)) {
+                result += "error invalid query";
+                return;
+            }
+            if (strcmp(query.kind, "dijkstra") != 0) {
+                result += "error unknown query";
+                return;
+            }
+            vector<Node> &path = paths[threadIdx];
+            if (query.start == query.goal) {
+                path.assign(1, query.start);
+                appendPathAnswer(result, true, 0, path);
+                return;
+            }
+            DijkstraWorkspace &workspace = workspaces[threadIdx];
+            const bool found = dijkstra(graph, query.start, query.goal, path, workspace);
+            appendPathAnswer(result, found, found ? workspace.parent[query.goal].weight : -1, path);
+        };
+        // The answers go to stdout, so everything else goes to stderr
+        cerr << "Loaded " << graph.size() << " nodes and " << graph.edgesCount() << " edges in " << timer.elapsedMs() << " ms, serving with "
+             << pool.size() << " threads\n";
+        if (socketPath != nullptr) {
+            serveUnixSocket(socketPath, pool, answer);
+        }
+        else {
+            serveQueries(0, 1, pool, answer);
+        }
+    }
+    catch (const exception &e) {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    // Run a benchmark instead of the example if requested with "bench <name> [nodes] [degree]"
+    if (argc > 2 && strcmp(argv[1], "bench") == 0) {
+        return runBenchmark(argv[2], argc - 3, argv + 3) ? 0 : 1;
+    }
+    // Build landmarks for a graph file if requested with "landmarks <graph.bin> <output.bin> [count]"
+    if (argc > 3 && strcmp(argv[1], "landmarks") == 0) {
+        return writeLandmarksForGraphFile(argv[2], argv[3], (argc > 4) ? atoi(argv[4]) : 16);
+    }
+    // Search with ALT in a graph file if requested with "alt <graph.bin> <landmarks.bin> <start> <goal>"
+    if (argc == 6 && strcmp(argv[1], "alt") == 0) {
+        return searchAltInGraphFile(argv[2], argv[3], atoi(argv[4]), atoi(argv[5]));
+    }
+    // Serve queries on a graph file if requested with "serve <graph.bin> [threads] [socket path]"
+    if (argc > 2 && strcmp(argv[1], "serve") == 0) {
+        const int threadsCount = (argc > 3) ? atoi(argv[3]) : max(int(thread::hardware_concurrency()), 1);
+        return serveGraphFile(argv[2], threadsCount, (argc > 4) ? argv[4] : nullptr);
+    }
+    // Search in a graph file instead of the example graph if requested with "<graph.bin> <start> <goal>"
+    if (argc == 4) {
+        return searchInGraphFile(argv[1], atoi(argv[2]), atoi(argv[3]));
+    }
+
     // Create graph
     const Graph graph {
         { { 1, 2 }, { 2, 12 }, { 4, 4 } },
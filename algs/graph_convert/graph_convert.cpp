@@ -0,0 +1,139 @@
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include "../common/csr_graph.h"
+#include "../common/graph_file.h"
+using namespace std;
+
+const int MAX_INPUT_LINE_LENGTH = 256;
+
+// Target of an edge read from a text file, the weight is 1 if the file has no weights
+struct TextEdge {
+    Node node;
+    int weight;
+};
+
+struct TextGraph {
+    int nodesCount = 0;
+    bool hasWeights = false;
+    vector< pair<Node, TextEdge> > edges;
+};
+
+// Returns true if the file path ends with the given extension
+bool hasExtension(const char *filepath, const char *extension) {
+    const size_t pathLength = strlen(filepath);
+    const size_t extLength = strlen(extension);
+    return pathLength >= extLength && strcmp(filepath + pathLength - extLength, extension) == 0;
+}
+
+// Reads a plain edge list, one "source target [weight]" edge per line with 0-based nodes.
+// Empty lines and lines starting with # or % are skipped. The number of nodes is one more than the largest node.
+TextGraph readEdgeList(FILE *file) {
+    TextGraph graph;
+    char inputLine[MAX_INPUT_LINE_LENGTH + 1];
+    bool firstEdge = true;
+    while (fgets(inputLine, sizeof(inputLine), file) != nullptr) {
+        if (inputLine[0] == '#' || inputLine[0] == '%' || inputLine[0] == '\n' || inputLine[0] == '\r') {
+            continue;
+        }
+        char *pos = inputLine;
+        char *end;
+        const long source = strtol(pos, &end, 10);
+        if (end == pos) {
+            throw runtime_error("Invalid edge line in edge list.");
+        }
+        pos = end;
+        const long target = strtol(pos, &end, 10);
+        if (end == pos || source < 0 || target < 0) {
+            throw runtime_error("Invalid edge line in edge list.");
+        }
+        pos = end;
+        const long weight = strtol(pos, &end, 10);
+        const bool lineHasWeight = (end != pos);
+        // The first edge decides whether the whole file is weighted
+        if (firstEdge) {
+            graph.hasWeights = lineHasWeight;
+            firstEdge = false;
+        }
+        else if (graph.hasWeights != lineHasWeight) {
+            throw runtime_error("Edge list mixes weighted and unweighted edges.");
+        }
+        graph.edges.push_back({ Node(source), { Node(target), lineHasWeight ? int(weight) : 1 } });
+        graph.nodesCount = max(graph.nodesCount, int(max(source, target)) + 1);
+    }
+    return graph;
+}
+
+// Reads a DIMACS shortest path file, with a "p sp <nodes> <edges>" problem line and "a <source> <target> <weight>" arc lines.
+// Nodes in the file are 1-based and get converted to 0-based. Lines starting with c are comments.
+TextGraph readDimacs(FILE *file) {
+    TextGraph graph;
+    graph.hasWeights = true;
+    char inputLine[MAX_INPUT_LINE_LENGTH + 1];
+    bool hasProblemLine = false;
+    while (fgets(inputLine, sizeof(inputLine), file) != nullptr) {
+        if (inputLine[0] == 'p') {
+            int edgesCount;
+            if (sscanf(inputLine, "p sp %d %d", &graph.nodesCount, &edgesCount) != 2) {
+                throw runtime_error("Invalid problem line in DIMACS file.");
+            }
+            graph.edges.reserve(edgesCount);
+            hasProblemLine = true;
+        }
+        else if (inputLine[0] == 'a') {
+            int source, target, weight;
+            if (!hasProblemLine || sscanf(inputLine, "a %d %d %d", &source, &target, &weight) != 3) {
+                throw runtime_error("Invalid arc line in DIMACS file.");
+            }
+            if (source < 1 || source > graph.nodesCount || target < 1 || target > graph.nodesCount) {
+                throw runtime_error("Arc with invalid node in DIMACS file.");
+            }
+            graph.edges.push_back({ source - 1, { target - 1, weight } });
+        }
+    }
+    if (!hasProblemLine) {
+        throw runtime_error("DIMACS file has no problem line.");
+    }
+    return graph;
+}
+
+// Converts a text graph file to the binary graph file format, which can then be mapped with GraphFile
+void convert(const char *inputPath, const char *outputPath) {
+    FILE *file = fopen(inputPath, "r");
+    if (file == nullptr) {
+        throw runtime_error("Cannot open input graph file.");
+    }
+    const TextGraph textGraph = hasExtension(inputPath, ".gr") ? readDimacs(file) : readEdgeList(file);
+    fclose(file);
+
+    // Group the edges by source node and split the targets from the weights
+    const CsrGraph<TextEdge> csr = buildCsr(textGraph.nodesCount, textGraph.edges);
+    vector<Node> targets(csr.edgesCount());
+    vector<int> weights(textGraph.hasWeights ? csr.edgesCount() : 0);
+    for (int idx = 0; idx < csr.edgesCount(); idx++) {
+        targets[idx] = csr.targets[idx].node;
+        if (textGraph.hasWeights) {
+            weights[idx] = csr.targets[idx].weight;
+        }
+    }
+    writeGraphFile(outputPath, csr.offsets, targets, weights);
+    cout << "Written " << csr.size() << " nodes and " << csr.edgesCount() << (textGraph.hasWeights ? " weighted" : "") << " edges\n";
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        cout << "Usage: graph_convert <input.txt | input.gr> <output.bin>\n";
+        return 1;
+    }
+    try {
+        convert(argv[1], argv[2]);
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,525 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include "../common/bench.h"
+#include "../common/epoch_array.h"
+#include "../common/indexed_heap.h"
+using namespace std;
+
+const int DIST_INF = 2147483647;
+
+// Costs of a straight and a diagonal step, in integers with the diagonal one close to sqrt(2) times the straight one
+const int STRAIGHT_COST = 1000;
+const int DIAGONAL_COST = 1414;
+
+const int MAX_INPUT_LINE_LENGTH = 4096;
+
+typedef int Node;
+
+/// 8-connected grid map with one bit per cell, set for the cells that can be walked on.
+/// The node of cell (row, col) is row * width + col, like in the grid graphs of generateGridEdges(), so paths are lists of cells.
+/// Every row is padded with a zero word on both sides, so that any 64 consecutive cells of a row starting from column -64
+/// up to width can be read with freeBits() as a single word, and cells outside the map read as blocked.
+struct GridMap {
+    GridMap(int width, int height)
+        : width(width)
+        , height(height)
+        , rowWords((width + 63) / 64 + 2)
+        , words(size_t(rowWords) * height, 0)
+    {}
+
+    int width;
+    int height;
+
+    int size() const {
+        return width * height;
+    }
+
+    Node node(int row, int col) const {
+        return row * width + col;
+    }
+
+    bool isFree(int row, int col) const {
+        if (row < 0 || row >= height || col < 0 || col >= width) {
+            return false;
+        }
+        const int bit = col + 64;
+        return (words[size_t(row) * rowWords + bit / 64] >> (bit % 64)) & 1;
+    }
+
+    void setFree(int row, int col, bool free) {
+        const int bit = col + 64;
+        uint64_t &word = words[size_t(row) * rowWords + bit / 64];
+        const uint64_t mask = uint64_t(1) << (bit % 64);
+        word = free ? (word | mask) : (word & ~mask);
+    }
+
+    /// Returns the cells from firstCol to firstCol + 63 of the row as the bits of a word, from the lowest bit up
+    uint64_t freeBits(int row, int firstCol) const {
+        if (row < 0 || row >= height) {
+            return 0;
+        }
+        const uint64_t *rowData = words.data() + size_t(row) * rowWords;
+        const int bit = firstCol + 64;
+        const int shift = bit % 64;
+        const uint64_t low = rowData[bit / 64] >> shift;
+        return (shift == 0) ? low : (low | (rowData[bit / 64 + 1] << (64 - shift)));
+    }
+
+    size_t sizeInBytes() const {
+        return words.size() * sizeof(uint64_t);
+    }
+
+private:
+    int rowWords;
+    vector<uint64_t> words;
+};
+
+/// Parent of a cell on the best path found to it and the cost of that path, -1 for no parent and -2 for the start cell.
+/// With jump point search the parent is the previous jump point, on a straight or diagonal line from the cell.
+struct GridParent {
+    Node node;
+    int dist;
+};
+
+/// Memory for grid searches that is kept by the caller and reused across searches on maps with the same number of cells.
+struct GridSearchWorkspace {
+    GridSearchWorkspace(int cellsCount)
+        : parent(cellsCount, { -1, DIST_INF })
+        , closed(cellsCount, false)
+        , queue(cellsCount)
+    {}
+
+    EpochArray<GridParent> parent;
+    EpochArray<char> closed;
+    IndexedDaryHeap<4> queue;
+    // Number of cells expanded by the last search
+    long long expandedCount = 0;
+};
+
+// Returns the octile distance between two cells, the cost of the shortest path between them on a map without obstacles.
+// It is the heuristic of the A* searches and also the cost of a straight or diagonal line of cells.
+inline int octileDistance(const GridMap &grid, Node from, Node to) {
+    const int rowDiff = abs(from / grid.width - to / grid.width);
+    const int colDiff = abs(from % grid.width - to % grid.width);
+    return DIAGONAL_COST * min(rowDiff, colDiff) + STRAIGHT_COST * abs(rowDiff - colDiff);
+}
+
+// Calls addNeighbour(node) for every free cell next to the given one. A diagonal step is allowed only if both cells
+// it passes by are free, so paths never cut the corners of obstacles.
+template <typename AddNeighbour>
+void forEachGridNeighbour(const GridMap &grid, Node node, AddNeighbour addNeighbour) {
+    const int row = node / grid.width;
+    const int col = node % grid.width;
+    for (int dRow = -1; dRow <= 1; dRow++) {
+        for (int dCol = -1; dCol <= 1; dCol++) {
+            if ((dRow == 0 && dCol == 0) || !grid.isFree(row + dRow, col + dCol)) {
+                continue;
+            }
+            if (dRow != 0 && dCol != 0 && !(grid.isFree(row + dRow, col) && grid.isFree(row, col + dCol))) {
+                continue;
+            }
+            addNeighbour(grid.node(row + dRow, col + dCol));
+        }
+    }
+}
+
+/// A* search on the grid from start cell to goal cell, with the octile distance as heuristic if useHeuristic is set,
+/// or Dijkstra if it is not. The cells to go to next from a cell are given by successors(curr, parent, addSuccessor),
+/// which calls addSuccessor(node) for each of them, and every one must be on a straight or diagonal line of free cells from curr.
+/// The workspace parent array gets the parent of each reached cell and the cost of the path to it.
+template <typename Successors>
+bool gridSearchCore(const GridMap &grid, Node start, Node goal, bool useHeuristic, GridSearchWorkspace &ws, Successors successors) {
+    ws.parent.reset();
+    ws.closed.reset();
+    ws.expandedCount = 0;
+    ws.parent[start] = { -2, 0 };
+    ws.queue.pushOrDecrease(start, useHeuristic ? octileDistance(grid, start, goal) : 0);
+    while (!ws.queue.empty()) {
+        const Node curr = ws.queue.popMin();
+        ws.closed[curr] = true;
+        if (curr == goal) {
+            ws.queue.clear();
+            return true;
+        }
+        ws.expandedCount++;
+        const GridParent currParent = ws.parent[curr];
+        successors(curr, currParent.node, [&](Node next) {
+            // The heuristic is consistent, so a closed cell already has its shortest path
+            if (ws.closed[next]) {
+                return;
+            }
+            const int nextDist = currParent.dist + octileDistance(grid, curr, next);
+            if (nextDist < ws.parent[next].dist) {
+                ws.parent[next] = { curr, nextDist };
+                ws.queue.pushOrDecrease(next, nextDist + (useHeuristic ? octileDistance(grid, next, goal) : 0));
+            }
+        });
+    }
+    return false;
+}
+
+// Fills the path vector with every cell from the start to the goal, by following the parents back from the goal
+// and filling in the cells of the straight or diagonal line between each cell and its parent.
+void traceGridPath(const GridMap &grid, const EpochArray<GridParent> &parent, Node start, Node goal, vector<Node> &path) {
+    path.clear();
+    for (Node curr = goal; curr != start; curr = parent[curr].node) {
+        const Node prev = parent[curr].node;
+        const int dRow = (curr / grid.width > prev / grid.width) ? -1 : (curr / grid.width < prev / grid.width) ? 1 : 0;
+        const int dCol = (curr % grid.width > prev % grid.width) ? -1 : (curr % grid.width < prev % grid.width) ? 1 : 0;
+        for (Node cell = curr; cell != prev; cell += dRow * grid.width + dCol) {
+            path.push_back(cell);
+        }
+    }
+    path.push_back(start);
+    reverse(path.begin(), path.end());
+}
+
+/// A* search on the grid the shortest path from start cell to goal cell, expanding every free neighbour of each cell.
+/// It is the plain search that jump point search prunes, and with useHeuristic unset it is Dijkstra.
+/// The function returns true if a path is found, and fills the path vector with all its cells.
+bool gridAStar(const GridMap &grid, Node start, Node goal, vector<Node> &path, GridSearchWorkspace &ws, bool useHeuristic = true) {
+    const auto successors = [&](Node curr, Node, auto addSuccessor) {
+        forEachGridNeighbour(grid, curr, addSuccessor);
+    };
+    if (gridSearchCore(grid, start, goal, useHeuristic, ws, successors)) {
+        traceGridPath(grid, ws.parent, start, goal, path);
+        return true;
+    }
+    return false;
+}
+
+// Jumps horizontally from the cell, with dCol 1 to the right or -1 to the left, and returns the first jump point,
+// or -1 if the jump runs into an obstacle first. A cell is a jump point if it is the goal or has a forced neighbour,
+// a free cell above or below it whose own cell behind, towards where the jump came from, is blocked,
+// as then the shortest path to that neighbour may have to turn here. Without corner cutting there are no other forced neighbours.
+// The cells of the row and of the rows above and below are checked 64 at a time, so long open runs take a few word operations.
+Node jumpHorizontal(const GridMap &grid, int row, int col, int dCol, Node goal) {
+    const int goalRow = goal / grid.width;
+    const int goalCol = goal % grid.width;
+    while (true) {
+        // The next 64 cells in the direction of the jump, going up from the lowest bit to the right and down from the highest one to the left
+        const int firstCol = (dCol > 0) ? col + 1 : col - 64;
+        const uint64_t free = grid.freeBits(row, firstCol);
+        const uint64_t aboveForced = grid.freeBits(row - 1, firstCol) & ~grid.freeBits(row - 1, firstCol - dCol);
+        const uint64_t belowForced = grid.freeBits(row + 1, firstCol) & ~grid.freeBits(row + 1, firstCol - dCol);
+        const uint64_t stops = ~free | aboveForced | belowForced;
+        // Number of steps to the nearest cell where the jump stops, blocked or a jump point, or past the 64 cells if none does
+        const int stopSteps = (stops == 0) ? 65
+                            : (dCol > 0) ? __builtin_ctzll(stops) + 1
+                            : __builtin_clzll(stops) + 1;
+        const int goalSteps = (row == goalRow) ? (goalCol - col) * dCol : 0;
+        if (goalSteps > 0 && goalSteps <= min(stopSteps, 64)) {
+            return goal;
+        }
+        if (stops == 0) {
+            col += 64 * dCol;
+            continue;
+        }
+        const int stopCol = col + stopSteps * dCol;
+        return grid.isFree(row, stopCol) ? grid.node(row, stopCol) : -1;
+    }
+}
+
+// Jumps vertically from the cell, with dRow 1 down or -1 up, and returns the first jump point, or -1 if the jump runs into an obstacle first.
+// A cell is a jump point if it is the goal or has a free cell to its left or right whose own cell behind is blocked.
+Node jumpVertical(const GridMap &grid, int row, int col, int dRow, Node goal) {
+    while (true) {
+        row += dRow;
+        if (!grid.isFree(row, col)) {
+            return -1;
+        }
+        const Node node = grid.node(row, col);
+        if (node == goal) {
+            return node;
+        }
+        if ((grid.isFree(row, col - 1) && !grid.isFree(row - dRow, col - 1)) || (grid.isFree(row, col + 1) && !grid.isFree(row - dRow, col + 1))) {
+            return node;
+        }
+    }
+}
+
+// Jumps diagonally from the cell in the given direction and returns the first jump point, or -1 if the jump runs into an obstacle first.
+// A cell is a jump point if it is the goal or if a horizontal or vertical jump from it, in the directions of the diagonal, finds one.
+Node jumpDiagonal(const GridMap &grid, int row, int col, int dRow, int dCol, Node goal) {
+    while (true) {
+        // A diagonal step needs both cells it passes by to be free
+        if (!grid.isFree(row + dRow, col) || !grid.isFree(row, col + dCol) || !grid.isFree(row + dRow, col + dCol)) {
+            return -1;
+        }
+        row += dRow;
+        col += dCol;
+        const Node node = grid.node(row, col);
+        if (node == goal || jumpHorizontal(grid, row, col, dCol, goal) != -1 || jumpVertical(grid, row, col, dRow, goal) != -1) {
+            return node;
+        }
+    }
+}
+
+// Calls addSuccessor(node) for the jump points found from the cell in the directions that jump point search does not prune.
+// The first cell has no parent and jumps in all 8 directions. Otherwise the direction is the one from the parent,
+// a diagonal one continues diagonally and in its two straight parts, and a straight one continues straight
+// and turns only towards its forced neighbours.
+template <typename AddSuccessor>
+void forEachJumpSuccessor(const GridMap &grid, Node curr, Node parentNode, Node goal, AddSuccessor addSuccessor) {
+    const int row = curr / grid.width;
+    const int col = curr % grid.width;
+    const auto addJump = [&](Node jumpPoint) {
+        if (jumpPoint != -1) {
+            addSuccessor(jumpPoint);
+        }
+    };
+    if (parentNode < 0) {
+        for (int dir = -1; dir <= 1; dir += 2) {
+            addJump(jumpHorizontal(grid, row, col, dir, goal));
+            addJump(jumpVertical(grid, row, col, dir, goal));
+            addJump(jumpDiagonal(grid, row, col, dir, -1, goal));
+            addJump(jumpDiagonal(grid, row, col, dir, 1, goal));
+        }
+        return;
+    }
+    const int dRow = (row > parentNode / grid.width) ? 1 : (row < parentNode / grid.width) ? -1 : 0;
+    const int dCol = (col > parentNode % grid.width) ? 1 : (col < parentNode % grid.width) ? -1 : 0;
+    if (dRow != 0 && dCol != 0) {
+        addJump(jumpHorizontal(grid, row, col, dCol, goal));
+        addJump(jumpVertical(grid, row, col, dRow, goal));
+        addJump(jumpDiagonal(grid, row, col, dRow, dCol, goal));
+    }
+    else if (dRow == 0) {
+        addJump(jumpHorizontal(grid, row, col, dCol, goal));
+        for (int side = -1; side <= 1; side += 2) {
+            if (grid.isFree(row + side, col) && !grid.isFree(row + side, col - dCol)) {
+                addJump(jumpVertical(grid, row, col, side, goal));
+                addJump(jumpDiagonal(grid, row, col, side, dCol, goal));
+            }
+        }
+    }
+    else {
+        addJump(jumpVertical(grid, row, col, dRow, goal));
+        for (int side = -1; side <= 1; side += 2) {
+            if (grid.isFree(row, col + side) && !grid.isFree(row - dRow, col + side)) {
+                addJump(jumpHorizontal(grid, row, col, side, goal));
+                addJump(jumpDiagonal(grid, row, col, dRow, side, goal));
+            }
+        }
+    }
+}
+
+/// Jump point search by Harabor and Grastien, the shortest path from start cell to goal cell on an 8-connected uniform-cost grid,
+/// reusing the given workspace. It is A* that skips the cells of the many symmetric shortest paths of a grid: from each cell it
+/// jumps along straight and diagonal lines and only stops at jump points, where an obstacle nearby may force the path to turn.
+/// The function returns true if a path is found, and fills the path vector with all its cells, not only the jump points.
+bool jps(const GridMap &grid, Node start, Node goal, vector<Node> &path, GridSearchWorkspace &ws) {
+    const auto successors = [&](Node curr, Node parentNode, auto addSuccessor) {
+        forEachJumpSuccessor(grid, curr, parentNode, goal, addSuccessor);
+    };
+    if (gridSearchCore(grid, start, goal, true, ws, successors)) {
+        traceGridPath(grid, ws.parent, start, goal, path);
+        return true;
+    }
+    return false;
+}
+
+/// Same as the jps() above, with a new workspace.
+bool jps(const GridMap &grid, Node start, Node goal, vector<Node> &path) {
+    GridSearchWorkspace ws(grid.size());
+    return jps(grid, start, goal, path, ws);
+}
+
+/// Reads a grid map in the format of the Moving AI benchmark maps: a header with the height and the width of the map,
+/// then a line with "map" and a line of characters per row, where '.', 'G' and 'S' are free cells and all others are blocked.
+GridMap readMovingAiMap(const char *filepath) {
+    FILE *file = fopen(filepath, "r");
+    if (file == nullptr) {
+        throw runtime_error("Cannot open map file.");
+    }
+    char inputLine[MAX_INPUT_LINE_LENGTH + 1];
+    int width = -1;
+    int height = -1;
+    while (fgets(inputLine, sizeof(inputLine), file) != nullptr && strncmp(inputLine, "map", 3) != 0) {
+        sscanf(inputLine, "height %d", &height);
+        sscanf(inputLine, "width %d", &width);
+    }
+    if (width <= 0 || height <= 0 || width > MAX_INPUT_LINE_LENGTH - 2) {
+        fclose(file);
+        throw runtime_error("Invalid map file header.");
+    }
+    GridMap grid(width, height);
+    for (int row = 0; row < height; row++) {
+        if (fgets(inputLine, sizeof(inputLine), file) == nullptr || int(strcspn(inputLine, "\r\n")) < width) {
+            fclose(file);
+            throw runtime_error("Map file is truncated.");
+        }
+        for (int col = 0; col < width; col++) {
+            const char cell = inputLine[col];
+            grid.setFree(row, col, cell == '.' || cell == 'G' || cell == 'S');
+        }
+    }
+    fclose(file);
+    return grid;
+}
+
+// Returns a square map with the given side, where each cell is blocked with the given probability in percent
+GridMap generateRandomGrid(int side, int blockedPercent, unsigned seed = 1) {
+    mt19937 rng(seed);
+    uniform_int_distribution<int> percentDist(0, 99);
+    GridMap grid(side, side);
+    for (int row = 0; row < side; row++) {
+        for (int col = 0; col < side; col++) {
+            grid.setFree(row, col, percentDist(rng) >= blockedPercent);
+        }
+    }
+    return grid;
+}
+
+// Returns the given number of random free cells of the map
+vector<Node> generateRandomFreeCells(const GridMap &grid, int count, unsigned seed = 2) {
+    mt19937 rng(seed);
+    uniform_int_distribution<Node> nodeDist(0, grid.size() - 1);
+    vector<Node> cells;
+    while (int(cells.size()) < count) {
+        const Node cell = nodeDist(rng);
+        if (grid.isFree(cell / grid.width, cell % grid.width)) {
+            cells.push_back(cell);
+        }
+    }
+    return cells;
+}
+
+// Compares Dijkstra, A* and jump point search between random free cells of a random map,
+// and the memory of the bit-packed map with the memory the same map would take as an explicit weighted CSR graph
+void benchJps(int side, int blockedPercent) {
+    cout << "Grid searches on a random " << side << " x " << side << " map with " << blockedPercent << "% blocked cells\n";
+    const GridMap grid = generateRandomGrid(side, blockedPercent);
+    long long edgesCount = 0;
+    for (Node cell = 0; cell < grid.size(); cell++) {
+        forEachGridNeighbour(grid, cell, [&](Node) { edgesCount++; });
+    }
+    const double graphMb = ((grid.size() + 1) * sizeof(int) + edgesCount * 2 * sizeof(int)) / (1024.0 * 1024.0);
+    cout << "  bit-packed map: " << grid.sizeInBytes() / (1024.0 * 1024.0) << " MB, as a CSR graph: " << graphMb << " MB\n";
+
+    const int queriesCount = 100;
+    const vector<Node> starts = generateRandomFreeCells(grid, queriesCount, 2);
+    const vector<Node> goals = generateRandomFreeCells(grid, queriesCount, 3);
+    const char *searchNames[] = { "Dijkstra", "A*", "jump point search" };
+    vector<int> firstDists;
+    GridSearchWorkspace ws(grid.size());
+    vector<Node> path;
+    for (int searchIdx = 0; searchIdx < 3; searchIdx++) {
+        vector<int> dists(queriesCount, -1);
+        long long expandedCount = 0;
+        Timer timer;
+        for (int query = 0; query < queriesCount; query++) {
+            const bool found = (searchIdx == 2) ? jps(grid, starts[query], goals[query], path, ws)
+                             : gridAStar(grid, starts[query], goals[query], path, ws, searchIdx == 1);
+            if (found) {
+                dists[query] = ws.parent[goals[query]].dist;
+            }
+            expandedCount += ws.expandedCount;
+        }
+        const double queryMs = timer.elapsedMs() / queriesCount;
+        cout << "  " << searchNames[searchIdx] << ": " << queryMs << " ms/query, " << expandedCount / queriesCount << " expanded cells/query";
+        if (searchIdx == 0) {
+            firstDists = dists;
+            cout << "\n";
+        }
+        else {
+            cout << ", " << (dists == firstDists ? "same path costs" : "DIFFERENT path costs") << "\n";
+        }
+    }
+}
+
+// Runs the benchmark with the given name, with optional size parameters from the command line.
+// Returns false if there is no such benchmark.
+bool runBenchmark(const char *name, int argc, char **argv) {
+    if (strcmp(name, "jps") == 0) {
+        benchJps((argc > 0) ? atoi(argv[0]) : 1000, (argc > 1) ? atoi(argv[1]) : 20);
+        return true;
+    }
+    cout << "Unknown benchmark " << name << "\n";
+    return false;
+}
+
+// Prints the given path to the console as a list of cells, separated with commas.
+void printPath(const vector<Node> &path) {
+    for (int idx = 0; idx < int(path.size()); idx++) {
+        cout << path[idx];
+        if (idx + 1 < int(path.size())) {
+            cout << ", ";
+        }
+    }
+    cout << "\n";
+}
+
+// Searches a path between the given cells of a map loaded from a Moving AI map file and prints it.
+// Returns the exit code for main().
+int searchInMapFile(const char *filepath, Node start, Node goal) {
+    try {
+        Timer timer;
+        const GridMap grid = readMovingAiMap(filepath);
+        cout << "Loaded " << grid.width << " x " << grid.height << " map in " << timer.elapsedMs() << " ms\n";
+        if (start < 0 || start >= grid.size() || goal < 0 || goal >= grid.size()) {
+            cout << "Invalid start or goal cell\n";
+            return 1;
+        }
+        vector<Node> path;
+        timer.restart();
+        const bool found = jps(grid, start, goal, path);
+        cout << "Searched in " << timer.elapsedMs() << " ms\n";
+        if (found) {
+            cout << "Path found: ";
+            printPath(path);
+        }
+        else {
+            cout << "No path :(\n";
+        }
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    // Run a benchmark instead of the example if requested with "bench jps [side] [blocked percent]"
+    if (argc > 2 && strcmp(argv[1], "bench") == 0) {
+        return runBenchmark(argv[2], argc - 3, argv + 3) ? 0 : 1;
+    }
+    // Search in a map file instead of the example map if requested with "<file.map> <start cell> <goal cell>"
+    if (argc == 4) {
+        return searchInMapFile(argv[1], atoi(argv[2]), atoi(argv[3]));
+    }
+
+    // Create map, with # for blocked cells
+    const char *rows[] = {
+        "....#...",
+        "....#...",
+        "....#...",
+        "........",
+    };
+    GridMap grid(8, 4);
+    for (int row = 0; row < grid.height; row++) {
+        for (int col = 0; col < grid.width; col++) {
+            grid.setFree(row, col, rows[row][col] != '#');
+        }
+    }
+    const Node start = grid.node(0, 0);
+    const Node goal = grid.node(0, grid.width - 1);
+    vector<Node> path;
+    // Perform jump point search to find the shortest path
+    if (jps(grid, start, goal, path)) {
+        cout << "Path found: ";
+        printPath(path);
+    }
+    else {
+        cout << "No path :(\n";
+    }
+    return 0;
+}
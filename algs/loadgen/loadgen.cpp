@@ -0,0 +1,179 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "../common/csr_graph.h"
+#include "../common/bench.h"
+#include "../common/graph_file.h"
+#include "../common/query_server.h"
+using namespace std;
+
+// Load generator for the "serve" mode of the bfs, dfs and dijkstra programs.
+// It connects to the Unix socket of a server, keeps a fixed number of queries between random nodes in flight,
+// and reports the throughput and the latency percentiles of the answers.
+
+// Returns the current time in nanoseconds, on the clock that Timer uses
+long long nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Returns the value below which the given fraction of the sorted values are
+double percentile(const vector<double> &sortedValues, double fraction) {
+    const size_t idx = min(sortedValues.size() - 1, size_t(fraction * sortedValues.size()));
+    return sortedValues[idx];
+}
+
+#ifndef _WIN32
+// Connects to the Unix socket at the given path and returns its file descriptor
+int connectUnixSocket(const char *socketPath) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        throw runtime_error("Socket path is too long.");
+    }
+    strcpy(address.sun_path, socketPath);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw runtime_error("Cannot connect to " + string(socketPath) + ".");
+    }
+    return fd;
+}
+
+// Sends the given number of "<kind> <start> <goal>" queries between random nodes to the server, never more than maxInFlight unanswered,
+// and measures the time from sending each query to receiving its answer.
+void generateLoad(const char *socketPath, int nodesCount, const char *kind, int queriesCount, int maxInFlight) {
+    const vector<Node> nodes = generateRandomNodes(nodesCount, 2 * queriesCount);
+    const int fd = connectUnixSocket(socketPath);
+    // A server that goes away should fail the writes, not kill the load generator
+    signal(SIGPIPE, SIG_IGN);
+    // Send times are written by the sender and read by the receiver once the answer is back
+    vector< atomic<long long> > sendTimes(queriesCount);
+    int answeredCount = 0;
+    mutex answeredMutex;
+    condition_variable answeredChanged;
+
+    Timer timer;
+    // The sender writes all queries that fit in the window with a single system call, the way a real client would pipeline them
+    thread sender([&]() {
+        string text;
+        int sentCount = 0;
+        while (sentCount < queriesCount) {
+            int windowSize;
+            {
+                unique_lock<mutex> lock(answeredMutex);
+                answeredChanged.wait(lock, [&]() { return sentCount - answeredCount < maxInFlight; });
+                windowSize = min(maxInFlight - (sentCount - answeredCount), queriesCount - sentCount);
+            }
+            text.clear();
+            for (int idx = sentCount; idx < sentCount + windowSize; idx++) {
+                text += kind;
+                text += ' ';
+                text += to_string(nodes[2 * idx]);
+                text += ' ';
+                text += to_string(nodes[2 * idx + 1]);
+                text += '\n';
+            }
+            const long long sendTime = nowNs();
+            for (int idx = sentCount; idx < sentCount + windowSize; idx++) {
+                sendTimes[idx].store(sendTime, memory_order_release);
+            }
+            size_t written = 0;
+            while (written < text.size()) {
+                const ssize_t count = write(fd, text.data() + written, text.size() - written);
+                if (count <= 0) {
+                    cerr << "Error: cannot send queries\n";
+                    shutdown(fd, SHUT_RDWR);
+                    return;
+                }
+                written += size_t(count);
+            }
+            sentCount += windowSize;
+        }
+        // Let the server know there are no more queries, so it closes the connection after the last answer
+        shutdown(fd, SHUT_WR);
+    });
+
+    LineReader reader(fd);
+    vector<char*> lines;
+    vector<double> latenciesMs;
+    latenciesMs.reserve(queriesCount);
+    long long errorsCount = 0;
+    long long notFoundCount = 0;
+    while (int(latenciesMs.size()) < queriesCount && reader.readLines(lines, queriesCount)) {
+        const long long receiveTime = nowNs();
+        for (const char *line : lines) {
+            const long long sendTime = sendTimes[latenciesMs.size()].load(memory_order_acquire);
+            latenciesMs.push_back(double(receiveTime - sendTime) / 1e6);
+            if (strncmp(line, "error", 5) == 0) {
+                errorsCount++;
+            }
+            else if (strcmp(line, "-1") == 0 || strcmp(line, "0") == 0) {
+                notFoundCount++;
+            }
+        }
+        {
+            lock_guard<mutex> lock(answeredMutex);
+            answeredCount = int(latenciesMs.size());
+        }
+        answeredChanged.notify_one();
+    }
+    const double timeMs = timer.elapsedMs();
+    {
+        // Release the sender if the server went away before answering everything
+        lock_guard<mutex> lock(answeredMutex);
+        answeredCount = queriesCount;
+    }
+    answeredChanged.notify_one();
+    sender.join();
+    close(fd);
+
+    if (int(latenciesMs.size()) < queriesCount) {
+        throw runtime_error("The server closed the connection after " + to_string(latenciesMs.size()) + " answers.");
+    }
+    sort(latenciesMs.begin(), latenciesMs.end());
+    cout << "Answered " << queriesCount << " " << kind << " queries with up to " << maxInFlight << " in flight in " << timeMs << " ms\n";
+    cout << "    throughput: " << double(queriesCount) / (timeMs / 1000.0) << " queries/s\n";
+    cout << "    latency p50: " << percentile(latenciesMs, 0.5) << " ms, p99: " << percentile(latenciesMs, 0.99)
+         << " ms, max: " << latenciesMs.back() << " ms\n";
+    cout << "    " << notFoundCount << " without a path, " << errorsCount << " errors\n";
+}
+#endif
+
+int main(int argc, char **argv) {
+    if (argc < 4) {
+        cout << "Usage: loadgen <socket path> <graph.bin> <bfs | dfs | dijkstra | reach> [queries] [in flight]\n";
+        return 1;
+    }
+    const int queriesCount = (argc > 4) ? atoi(argv[4]) : 100000;
+    const int maxInFlight = (argc > 5) ? atoi(argv[5]) : 64;
+    try {
+#ifdef _WIN32
+        throw runtime_error("Unix sockets are not supported on this platform.");
+#else
+        if (queriesCount <= 0 || maxInFlight <= 0) {
+            throw runtime_error("The number of queries and of queries in flight must be positive.");
+        }
+        // The graph file is only needed for its number of nodes, to pick valid random queries
+        const GraphFile file(argv[2]);
+        generateLoad(argv[1], file.nodesCount(), argv[3], queriesCount, maxInFlight);
+#endif
+    }
+    catch (const exception &e) {
+        cout << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}